@@ -0,0 +1,117 @@
+#include "can_filter.h"
+
+namespace {
+
+// Найменший код/маска, що покриває всі додані образи.
+struct Cover {
+    uint32_t code = 0;
+    uint32_t mask = 0; // 1 = байдуже
+    bool empty = true;
+
+    void add(uint32_t image, uint32_t dont_care) {
+        if (empty) {
+            code = image;
+            mask = dont_care;
+            empty = false;
+        } else {
+            mask |= dont_care | (code ^ image);
+        }
+        code &= ~mask;
+    }
+};
+
+uint64_t span(uint32_t free_bits) {
+    return 1ULL << __builtin_popcount(free_bits);
+}
+
+// Розбиття на дві групи перебирається повністю: 2^(n-1) варіантів.
+const size_t MAX_DUAL_IDS = 16;
+
+CanFilterPlan singlePlan(const uint32_t *ids, size_t count) {
+    bool has_std = false, has_ext = false;
+    for (size_t i = 0; i < count; i++) {
+        if (isExtendedCanId(ids[i])) has_ext = true; else has_std = true;
+    }
+
+    // Біти даних (11-бітний формат) та RTR. Якщо формати змішані, одні й ті самі біти
+    // фільтра для одного формату - це ID, а для іншого - дані/RTR, тож вони "байдуже".
+    const uint32_t std_dont_care = has_ext ? 0x001FFFFF : 0x000FFFFF;
+    const uint32_t ext_dont_care = has_std ? 0x00000007 : 0x00000003;
+
+    Cover c;
+    for (size_t i = 0; i < count; i++) {
+        if (isExtendedCanId(ids[i])) {
+            c.add((ids[i] & CAN_EXT_ID_MASK) << 3, ext_dont_care);
+        } else {
+            c.add((ids[i] & CAN_STD_ID_MASK) << 21, std_dont_care);
+        }
+    }
+
+    CanFilterPlan plan;
+    plan.config.acceptance_code = c.code;
+    plan.config.acceptance_mask = c.mask;
+    plan.config.single_filter = true;
+    plan.accepted_ids = (has_std ? span(c.mask & 0xFFE00000) : 0) + (has_ext ? span(c.mask & 0xFFFFFFF8) : 0);
+    plan.exact = plan.accepted_ids == count;
+    return plan;
+}
+
+// Лише для списків одного формату; повертає false, якщо dual тут неможливий.
+bool dualPlan(const uint32_t *ids, size_t count, CanFilterPlan &best) {
+    if (count < 2 || count > MAX_DUAL_IDS) return false;
+    const bool ext = isExtendedCanId(ids[0]);
+    for (size_t i = 1; i < count; i++) {
+        if (isExtendedCanId(ids[i]) != ext) return false;
+    }
+
+    bool found = false;
+    for (uint32_t split = 1; split < (1UL << (count - 1)); split++) {
+        Cover a, b;
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t key = ext ? (ids[i] & CAN_EXT_ID_MASK) >> 13 : ids[i] & CAN_STD_ID_MASK;
+            // ID[0] завжди в групі a, решта - за бітами split
+            if (i > 0 && (split >> (i - 1)) & 1) b.add(key, 0); else a.add(key, 0);
+        }
+
+        CanFilterPlan plan;
+        plan.config.single_filter = false;
+        if (ext) {
+            // Молодші 13 біт ID не перевіряються
+            plan.accepted_ids = (span(a.mask & 0xFFFF) + span(b.mask & 0xFFFF)) << 13;
+            plan.config.acceptance_code = (a.code << 16) | b.code;
+            plan.config.acceptance_mask = (a.mask << 16) | b.mask;
+        } else {
+            plan.accepted_ids = span(a.mask & CAN_STD_ID_MASK) + span(b.mask & CAN_STD_ID_MASK);
+            // Фільтр 1: ID 31..21, RTR 20, байт даних 1 - біти 19..16 та 3..0.
+            // Фільтр 2: ID 15..5, RTR 4.
+            plan.config.acceptance_code = (a.code << 21) | (b.code << 5);
+            plan.config.acceptance_mask = (a.mask << 21) | 0x000F0000 | (b.mask << 5) | 0x0000000F;
+        }
+        plan.exact = plan.accepted_ids == count;
+
+        if (!found || plan.accepted_ids < best.accepted_ids) {
+            best = plan;
+            found = true;
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+CanFilterPlan planAcceptanceFilter(const uint32_t *ids, size_t count) {
+    if (count == 0) {
+        CanFilterPlan plan;
+        plan.config = {0, 0xFFFFFFFF, true}; // Accept all
+        plan.accepted_ids = 0;
+        plan.exact = false;
+        return plan;
+    }
+
+    CanFilterPlan plan = singlePlan(ids, count);
+    CanFilterPlan dual = {};
+    if (!plan.exact && dualPlan(ids, count, dual) && dual.accepted_ids < plan.accepted_ids) {
+        plan = dual;
+    }
+    return plan;
+}
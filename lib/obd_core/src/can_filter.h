@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_frame.h"
+
+// ############## Апаратний фільтр прийому TWAI ##############
+// Контролер TWAI має один 32-бітний фільтр (single) або два 16-бітні (dual):
+// код + маска, де біт маски 1 означає "байдуже". Планувальник підбирає
+// налаштування, що пропускає всі задані ID і якнайменше сторонніх:
+//  - single: 11-бітні ID у бітах 31..21 (біт 20 - RTR), 29-бітні - у бітах 31..3 (біт 2 - RTR);
+//  - dual, 11-бітні: фільтр 1 - біти 31..21, фільтр 2 - біти 15..5, кожен покриває свою групу ID;
+//  - dual, 29-бітні: кожен фільтр перевіряє лише ID[28:13].
+// Фільтр пропускає надмножину (сусідні ID, кадри іншого формату зі збіжними
+// старшими бітами), тому програмна перевірка ID у dispatchObdFrame() лишається завжди;
+// exact означає, що вона нічого не відкидає серед кадрів заданого формату.
+
+// Поля збігаються з twai_filter_config_t з ESP-IDF.
+struct AcceptanceFilter {
+    uint32_t acceptance_code;
+    uint32_t acceptance_mask; // 1 = байдуже
+    bool single_filter;
+};
+
+struct CanFilterPlan {
+    AcceptanceFilter config;
+    uint64_t accepted_ids; // Скільки ID (заданих форматів) пропускає апаратний фільтр
+    bool exact;
+};
+
+// ids - без повторів, 29-бітні позначені CAN_EXTENDED_FLAG. Порожній список -> accept all.
+CanFilterPlan planAcceptanceFilter(const uint32_t *ids, size_t count);
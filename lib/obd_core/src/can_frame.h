@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// ############## CAN-кадр ##############
+// Ядро протоколу (ISO-TP, кеш відповідей, черга передачі) працює з цим типом, а не
+// з twai_message_t, тож збирається й тестується без ESP-IDF. Перетворення з/у кадри
+// драйвера - на боці платформи (src/main.cpp).
+//
+// 29-бітні ID позначені старшим бітом (як CAN_EFF_FLAG у SocketCAN):
+// 0x7DF - 11-бітний, 0x18DB33F1 | CAN_EXTENDED_FLAG - 29-бітний.
+const uint32_t CAN_EXTENDED_FLAG = 0x80000000UL;
+const uint32_t CAN_STD_ID_MASK = 0x7FF;
+const uint32_t CAN_EXT_ID_MASK = 0x1FFFFFFF;
+const uint8_t CAN_MAX_DLC = 8;
+
+struct CanFrame {
+    uint32_t id;   // Разом з CAN_EXTENDED_FLAG
+    uint8_t dlc;   // 0 -> порожній кадр
+    uint8_t data[CAN_MAX_DLC];
+};
+
+inline bool isExtendedCanId(uint32_t id) { return (id & CAN_EXTENDED_FLAG) != 0; }
+
+// ID без прапорця - як його бачить драйвер
+inline uint32_t rawCanId(uint32_t id) {
+    return isExtendedCanId(id) ? (id & CAN_EXT_ID_MASK) : (id & CAN_STD_ID_MASK);
+}
@@ -0,0 +1,50 @@
+#include "can_recorder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+bool CanRecorder::record(const CanFrame &frame, uint64_t timestamp_us, bool tx) {
+    if (!recording()) return false;
+    CanRecord record = {};
+    record.timestamp_us = timestamp_us;
+    record.id = frame.id;
+    record.dlc = frame.dlc > CAN_MAX_DLC ? CAN_MAX_DLC : frame.dlc;
+    record.flags = tx ? CAN_RECORD_TX : 0;
+    memcpy(record.data, frame.data, record.dlc);
+    return ring_.push(record);
+}
+
+int formatCandumpLine(const CanRecord &r, const char *iface, char *buf, size_t size) {
+    static const char HEX[] = "0123456789ABCDEF";
+    char data[2 * CAN_MAX_DLC + 1];
+    const uint8_t dlc = r.dlc > CAN_MAX_DLC ? CAN_MAX_DLC : r.dlc;
+    for (uint8_t i = 0; i < dlc; i++) {
+        data[2 * i] = HEX[r.data[i] >> 4];
+        data[2 * i + 1] = HEX[r.data[i] & 0x0F];
+    }
+    data[2 * dlc] = '\0';
+    // Як candump: 3 цифри для 11-бітного ID, 8 - для 29-бітного
+    return snprintf(buf, size, isExtendedCanId(r.id) ? "(%010lu.%06lu) %s %08lX#%s\n" : "(%010lu.%06lu) %s %03lX#%s\n",
+                    (unsigned long)(r.timestamp_us / 1000000), (unsigned long)(r.timestamp_us % 1000000),
+                    iface, (unsigned long)rawCanId(r.id), data);
+}
+
+size_t CandumpStream::read(uint8_t *buf, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        if (linePos_ == lineLen_) {
+            CanRecord record;
+            if (!source_.next(record)) break;
+            const int len = formatCandumpLine(record, iface_, line_, sizeof(line_));
+            lineLen_ = len < 0 ? 0 : ((size_t)len < sizeof(line_) ? (size_t)len : sizeof(line_) - 1);
+            linePos_ = 0;
+            continue;
+        }
+        size_t n = lineLen_ - linePos_;
+        if (n > size - written) n = size - written;
+        memcpy(buf + written, line_ + linePos_, n);
+        linePos_ += n;
+        written += n;
+    }
+    return written;
+}
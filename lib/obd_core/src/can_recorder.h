@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_frame.h"
+#include "mpsc_ring.h"
+
+// ############## Запис CAN-трафіку ##############
+// Прийняті й передані кадри з мікросекундною міткою часу потрапляють у кільцевий
+// буфер без блокувань (CAN-задача, таймери ECU), а низькопріоритетна задача
+// скидає їх у файл бінарними записами CanRecord. Текст формату `candump -l`
+// генерується лише під час завантаження, порціями (CandumpStream), тож ні запис,
+// ні віддача файлу не тримають у RAM більше одного рядка.
+
+const uint8_t CAN_RECORD_TX = 1 << 0; // Кадр передав емулятор
+
+// 24 байти - і в буфері, і у файлі.
+struct CanRecord {
+    uint64_t timestamp_us;
+    uint32_t id;       // Разом з CAN_EXTENDED_FLAG
+    uint8_t dlc;
+    uint8_t flags;     // CAN_RECORD_*
+    uint8_t reserved[2];
+    uint8_t data[CAN_MAX_DLC];
+};
+static_assert(sizeof(CanRecord) == 24, "CanRecord is the on-flash format");
+
+class CanRecorder {
+public:
+    static const uint32_t CAPACITY = 512; // Степінь двійки; 12 КБ - ~100 мс завантаженої шини
+
+    void start() { recording_.store(true, std::memory_order_relaxed); }
+    void stop() { recording_.store(false, std::memory_order_relaxed); }
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+
+    // Викликається з будь-якої задачі. false - запис вимкнено або буфер заповнений.
+    bool record(const CanFrame &frame, uint64_t timestamp_us, bool tx);
+
+    // Лише для задачі, що скидає записи у файл.
+    bool pop(CanRecord &record) { return ring_.pop(record); }
+
+    // Кількість відкинутих записів з попереднього виклику.
+    uint32_t takeDropped() { return ring_.takeDropped(); }
+
+private:
+    MpscRing<CanRecord, CAPACITY> ring_;
+    std::atomic<bool> recording_{false};
+};
+
+// Рядок `candump -l` з переведенням рядка: "(0000000012.345678) can0 7E8#0441000C1AF8\n".
+// Час - від старту емулятора. Повертає довжину (як snprintf).
+int formatCandumpLine(const CanRecord &record, const char *iface, char *buf, size_t size);
+
+// Джерело записів для CandumpStream (файл на платформі, масив у тестах).
+class CanRecordSource {
+public:
+    virtual ~CanRecordSource() {}
+    // false - записів більше немає.
+    virtual bool next(CanRecord &record) = 0;
+};
+
+// Перетворює записи на текст `candump -l` порціями довільного розміру
+// (колбек chunked-відповіді веб-сервера), продовжуючи недописаний рядок.
+class CandumpStream {
+public:
+    static const size_t MAX_LINE = 64;
+
+    CandumpStream(CanRecordSource &source, const char *iface) : source_(source), iface_(iface) {}
+
+    // Записує до size байтів; 0 - кінець.
+    size_t read(uint8_t *buf, size_t size);
+
+private:
+    CanRecordSource &source_;
+    const char *iface_;
+    char line_[MAX_LINE];
+    size_t lineLen_ = 0;
+    size_t linePos_ = 0;
+};
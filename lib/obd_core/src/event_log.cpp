@@ -0,0 +1,50 @@
+#include "event_log.h"
+
+#include <stdio.h>
+
+bool EventLog::push(const LogEvent &event) {
+    if (!enabled((LogEventType)event.type)) return false;
+    return ring_.push(event);
+}
+
+int formatLogEvent(const LogEvent &e, const char *ecu_name, char *buf, size_t size) {
+    const unsigned long ms = e.timestamp_us / 1000;
+    const char *ecu = ecu_name ? ecu_name : "-";
+
+    switch (e.type) {
+        case EVT_CAN_RX:
+            if (e.value & 0x80000000UL) { // 29-бітний ID (CAN_EXTENDED_FLAG)
+                return snprintf(buf, size, "%8lu [CAN] RX 0x%08lX DLC %u", ms, (unsigned long)(e.value & 0x1FFFFFFF), e.length);
+            }
+            return snprintf(buf, size, "%8lu [CAN] RX 0x%03lX DLC %u", ms, (unsigned long)e.value, e.length);
+        case EVT_OBD_REQUEST:
+            return snprintf(buf, size, "%8lu [%s] Service 0x%02X, PID 0x%02X (%u PIDs), replied in %lu us",
+                            ms, ecu, e.service, e.pid, e.count, (unsigned long)e.value);
+        case EVT_ISOTP_DROPPED:
+            return snprintf(buf, size, "%8lu [%s] ISO-TP busy or payload too long, %u-byte response to 0x%02X dropped",
+                            ms, ecu, e.length, e.service);
+        case EVT_RX_QUEUE_FULL:
+            return snprintf(buf, size, "%8lu [CAN] TWAI RX queue full, frames dropped", ms);
+        case EVT_DTCS_CLEARED:
+            return snprintf(buf, size, "%8lu [%s] DTCs cleared (Service 04)", ms, ecu);
+        case EVT_DTC_ADDED: {
+            static const char SYSTEMS[] = {'P', 'C', 'B', 'U'};
+            return snprintf(buf, size, "%8lu [SIM] Simulated fault detected! Added DTC: %c%04lX",
+                            ms, SYSTEMS[(e.value >> 14) & 0x03], (unsigned long)(e.value & 0x3FFF));
+        }
+        case EVT_STATE_UPDATED:
+            return snprintf(buf, size, "%8lu [WEB] Emulator data updated: version %lu, %u DTCs",
+                            ms, (unsigned long)e.value, e.count);
+        case EVT_DRIVING_CYCLE:
+            return snprintf(buf, size, "%8lu [SIM] Driving cycle: error-free cycles %lu%s",
+                            ms, (unsigned long)e.value, e.count ? ", permanent DTCs cleared" : "");
+        case EVT_BUS_OFF:
+            return snprintf(buf, size, "%8lu [CAN] Bus-off, recovery initiated", ms);
+        case EVT_BUS_RECOVERED:
+            return snprintf(buf, size, "%8lu [CAN] Bus recovered, TWAI restarted", ms);
+        case EVT_TX_STALLED:
+            return snprintf(buf, size, "%8lu [CAN] TX stalled (no ACK?), controller reset, %lu frames discarded",
+                            ms, (unsigned long)e.value);
+    }
+    return snprintf(buf, size, "%8lu [?] event %u", ms, e.type);
+}
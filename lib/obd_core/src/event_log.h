@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mpsc_ring.h"
+
+// ############## Журнал подій ##############
+// CAN-шлях не пише в Serial: при 115200 бод один рядок займає кілька мс, а при
+// заповненому FIFO UART printf блокує задачу. Замість цього виробники (CAN-задача,
+// таймери esp_timer, веб-обробники) кладуть компактні бінарні записи в кільцевий
+// буфер без блокувань, а низькопріоритетна задача форматує та виводить їх.
+// Якщо буфер заповнений, запис відкидається і лише рахується - відповідь на
+// CAN-запит ніколи не чекає на журнал.
+
+enum LogLevel : uint8_t {
+    LOG_OFF = 0,
+    LOG_ERROR,
+    LOG_INFO,
+    LOG_DEBUG,
+};
+
+enum LogEventType : uint8_t {
+    EVT_CAN_RX,          // DEBUG: кадр прийнято (value = CAN ID з CAN_EXTENDED_FLAG, length = DLC)
+    EVT_OBD_REQUEST,     // INFO: запит оброблено (value = затримка від прийому до відповіді, мкс)
+    EVT_ISOTP_DROPPED,   // ERROR: ISO-TP зайнятий або payload завеликий (length = байтів)
+    EVT_RX_QUEUE_FULL,   // ERROR: RX-черга драйвера TWAI переповнена
+    EVT_DTCS_CLEARED,    // INFO: сервіс 04
+    EVT_DTC_ADDED,       // INFO: симуляція додала DTC (value = 2 байти DTC, як у сервісі 03)
+    EVT_STATE_UPDATED,   // INFO: стан змінено з веб-інтерфейсу (value = версія, count = кількість DTC)
+    EVT_DRIVING_CYCLE,   // INFO: value = циклів без помилок, count = 1 якщо Permanent DTC очищено
+    EVT_BUS_OFF,         // ERROR: контролер у bus-off, розпочато відновлення
+    EVT_BUS_RECOVERED,   // INFO: шину відновлено, драйвер знову запущено
+    EVT_TX_STALLED,      // ERROR: передача зависла (немає ACK), контролер скинуто (value = кадрів у драйвері)
+};
+
+const uint8_t LOG_NO_ECU = 0xFF;
+
+// 16 байтів на запис: 256 записів займають 4 КБ.
+struct LogEvent {
+    uint32_t timestamp_us;
+    uint32_t value;    // Значення залежить від type (див. LogEventType)
+    uint16_t length;
+    uint8_t type;
+    uint8_t ecu;       // Індекс віртуального ECU або LOG_NO_ECU
+    uint8_t service;
+    uint8_t pid;
+    uint8_t count;
+    uint8_t reserved;
+};
+
+constexpr LogLevel logLevelOf(LogEventType type) {
+    return type == EVT_CAN_RX ? LOG_DEBUG
+         : (type == EVT_ISOTP_DROPPED || type == EVT_RX_QUEUE_FULL ||
+            type == EVT_BUS_OFF || type == EVT_TX_STALLED) ? LOG_ERROR
+         : LOG_INFO;
+}
+
+// Записи - в MpscRing (mpsc_ring.h): виробники не блокують один одного.
+class EventLog {
+public:
+    static const uint32_t CAPACITY = 256; // Степінь двійки
+
+    void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return (LogLevel)level_.load(std::memory_order_relaxed); }
+    bool enabled(LogEventType type) const { return logLevelOf(type) <= level(); }
+
+    // Викликається з будь-якої задачі. false - запис відфільтровано або буфер заповнений.
+    bool push(const LogEvent &event);
+
+    // Лише для задачі-споживача.
+    bool pop(LogEvent &event) { return ring_.pop(event); }
+
+    // Кількість відкинутих записів з попереднього виклику.
+    uint32_t takeDropped() { return ring_.takeDropped(); }
+
+private:
+    MpscRing<LogEvent, CAPACITY> ring_;
+    std::atomic<uint8_t> level_{LOG_INFO};
+};
+
+// Форматує запис у рядок без переведення рядка. Повертає довжину (як snprintf).
+int formatLogEvent(const LogEvent &event, const char *ecu_name, char *buf, size_t size);
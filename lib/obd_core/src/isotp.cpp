@@ -0,0 +1,134 @@
+#include "isotp.h"
+
+#include <string.h>
+
+void IsoTpSender::begin(uint32_t tx_id, const Hooks &hooks) {
+    txId_ = tx_id;
+    hooks_ = hooks;
+    state_ = IDLE;
+}
+
+bool IsoTpSender::send(const uint8_t *payload, size_t len, uint32_t now_us) {
+    if (len == 0 || len > MAX_PAYLOAD) return false;
+
+    CanFrame tx_frame = {};
+    tx_frame.id = txId_;
+
+    if (len <= 7) {
+        tx_frame.data[0] = len; // PCI: Single Frame
+        memcpy(&tx_frame.data[1], payload, len);
+        tx_frame.dlc = 1 + len;
+        return hooks_.transmit(hooks_.ctx, tx_frame);
+    }
+    if (state_ != IDLE) return false;
+
+    // --- First Frame (FF) ---
+    tx_frame.dlc = 8;
+    tx_frame.data[0] = 0x10 | ((len >> 8) & 0x0F); // PCI: First Frame
+    tx_frame.data[1] = len & 0xFF;                 // PCI: Довжина
+    memcpy(&tx_frame.data[2], payload, 6);
+    if (!hooks_.transmit(hooks_.ctx, tx_frame)) return false;
+
+    memcpy(payload_, payload, len);
+    len_ = len;
+    pos_ = 6;
+    sequence_ = 1;
+    waitFrames_ = 0;
+    state_ = WAIT_FC;
+    schedule(now_us, N_BS_TIMEOUT_US);
+    return true;
+}
+
+void IsoTpSender::onFlowControl(const uint8_t *data, uint8_t len, uint32_t now_us) {
+    if (state_ != WAIT_FC || len < 3 || (data[0] & 0xF0) != 0x30) return;
+
+    switch (data[0] & 0x0F) {
+        case 0x0: // Continue To Send
+            blockSize_ = data[1];
+            stMinUs_ = decodeStMin(data[2]);
+            blockSent_ = 0;
+            waitFrames_ = 0;
+            state_ = SEND_CF;
+            sendBlock(now_us);
+            break;
+        case 0x1: // Wait - перезапускаємо N_Bs
+            if (++waitFrames_ > MAX_WAIT_FRAMES) {
+                abort();
+            } else {
+                schedule(now_us, N_BS_TIMEOUT_US);
+            }
+            break;
+        default: // Overflow або некоректний FS - передачу перервано
+            abort();
+            break;
+    }
+}
+
+void IsoTpSender::onTimer(uint32_t now_us) {
+    if (state_ == IDLE) return;
+    if ((int32_t)(now_us - deadline_) < 0) return; // Застарілий таймер
+
+    if (state_ == WAIT_FC) {
+        abort(); // N_Bs timeout: тестер не надіслав FC
+        return;
+    }
+    sendBlock(now_us);
+}
+
+void IsoTpSender::abort() {
+    state_ = IDLE;
+    len_ = 0;
+    pos_ = 0;
+}
+
+uint32_t IsoTpSender::decodeStMin(uint8_t st_min) {
+    if (st_min <= 0x7F) return st_min * 1000UL;
+    if (st_min >= 0xF1 && st_min <= 0xF9) return (st_min - 0xF0) * 100UL;
+    return 0x7F * 1000UL;
+}
+
+// Надсилає CF-и, доки дозволяє STmin: при STmin = 0 - весь блок одразу,
+// інакше один кадр і таймер на наступний.
+void IsoTpSender::sendBlock(uint32_t now_us) {
+    while (state_ == SEND_CF) {
+        if (!sendConsecutiveFrame()) {
+            abort();
+            return;
+        }
+        if (pos_ >= len_) {
+            abort(); // Передачу завершено
+            return;
+        }
+        if (blockSize_ != 0 && ++blockSent_ >= blockSize_) {
+            state_ = WAIT_FC;
+            schedule(now_us, N_BS_TIMEOUT_US);
+            return;
+        }
+        if (stMinUs_ != 0) {
+            schedule(now_us, stMinUs_);
+            return;
+        }
+    }
+}
+
+bool IsoTpSender::sendConsecutiveFrame() {
+    CanFrame tx_frame = {};
+    tx_frame.id = txId_;
+    tx_frame.dlc = 8;
+
+    size_t remaining = len_ - pos_;
+    size_t chunk = remaining > 7 ? 7 : remaining;
+    tx_frame.data[0] = 0x20 | (sequence_ & 0x0F); // PCI: Consecutive Frame
+    memcpy(&tx_frame.data[1], &payload_[pos_], chunk);
+    for (size_t i = 1 + chunk; i < 8; i++) tx_frame.data[i] = PADDING;
+
+    if (!hooks_.transmit(hooks_.ctx, tx_frame)) return false;
+    pos_ += chunk;
+    sequence_++;
+    return true;
+}
+
+void IsoTpSender::schedule(uint32_t now_us, uint32_t delay_us) {
+    deadline_ = now_us + delay_us;
+    hooks_.arm_timer(hooks_.ctx, delay_us);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "can_frame.h"
+
+// ############## ISO-TP (ISO 15765-2) передавач ##############
+// Надсилає довільне повідомлення до 4095 байтів: Single Frame, або First Frame,
+// після якого чекає Flow Control тестера та шле Consecutive Frames з урахуванням
+// BS (розмір блоку), STmin (мінімальний інтервал) та кадрів WAIT.
+//
+// Клас не працює з часом і таймерами напряму: він просить власника "розбудити"
+// його через hooks.arm_timer(), а власник викликає onTimer(). Клас не є
+// потокобезпечним - send(), onFlowControl() та onTimer() мають викликатися
+// під одним м'ютексом.
+class IsoTpSender {
+public:
+    static const size_t MAX_PAYLOAD = 4095;
+    static const uint32_t N_BS_TIMEOUT_US = 1000000; // Час очікування FC (N_Bs)
+    static const uint8_t MAX_WAIT_FRAMES = 10;       // N_WFTmax
+    static const uint8_t PADDING = 0xAA;
+
+    struct Hooks {
+        bool (*transmit)(void *ctx, const CanFrame &frame);
+        void (*arm_timer)(void *ctx, uint32_t delay_us);
+        void *ctx;
+    };
+
+    // tx_id: 29-бітний ID позначається CAN_EXTENDED_FLAG (див. can_frame.h).
+    void begin(uint32_t tx_id, const Hooks &hooks);
+
+    // Починає передачу. Single Frame надсилається одразу; для багатокадрової
+    // повертає false, якщо попередня ще триває або payload завеликий.
+    bool send(const uint8_t *payload, size_t len, uint32_t now_us);
+
+    // Обробляє Flow Control кадр (data[0] = 0x3X) від тестера.
+    void onFlowControl(const uint8_t *data, uint8_t len, uint32_t now_us);
+
+    // Викликається власником, коли спрацьовує таймер, заведений через arm_timer().
+    void onTimer(uint32_t now_us);
+
+    void abort();
+    bool busy() const { return state_ != IDLE; }
+
+    // STmin: 0x00-0x7F -> мс, 0xF1-0xF9 -> 100-900 мкс, решта зарезервовано (127 мс).
+    static uint32_t decodeStMin(uint8_t st_min);
+
+private:
+    enum State { IDLE, WAIT_FC, SEND_CF };
+
+    bool sendConsecutiveFrame();
+    void sendBlock(uint32_t now_us);
+    void schedule(uint32_t now_us, uint32_t delay_us);
+
+    Hooks hooks_ = {nullptr, nullptr, nullptr};
+    uint32_t txId_ = 0;
+    State state_ = IDLE;
+    uint8_t payload_[MAX_PAYLOAD];
+    size_t len_ = 0;
+    size_t pos_ = 0;
+    uint8_t sequence_ = 0;
+    uint8_t blockSize_ = 0;     // 0 -> без обмежень
+    uint8_t blockSent_ = 0;
+    uint8_t waitFrames_ = 0;
+    uint32_t stMinUs_ = 0;
+    uint32_t deadline_ = 0;
+};
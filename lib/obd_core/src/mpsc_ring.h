@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Обмежена черга з кількома виробниками та одним споживачем (за схемою Д. Вьюкова):
+// кожна комірка має власний лічильник послідовності, тож виробники резервують
+// комірки через CAS на head_ і не блокують один одного. Заповнений буфер не чекає
+// на споживача: запис відкидається і лише рахується.
+template <typename T, uint32_t CAPACITY>
+class MpscRing {
+public:
+    MpscRing() {
+        for (uint32_t i = 0; i < CAPACITY; i++) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Викликається з будь-якої задачі. false - буфер заповнений.
+    bool push(const T &item) {
+        uint32_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[pos & MASK];
+            const uint32_t seq = cell.seq.load(std::memory_order_acquire);
+            const int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                // Комірка вільна: резервуємо її, заповнюємо і публікуємо для споживача
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Споживач ще не звільнив комірку - буфер заповнений
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Лише для задачі-споживача.
+    bool pop(T &item) {
+        Cell &cell = cells_[tail_ & MASK];
+        const uint32_t seq = cell.seq.load(std::memory_order_acquire);
+        if ((int32_t)(seq - (tail_ + 1)) < 0) return false; // Порожньо або запис ще заповнюється
+        item = cell.item;
+        cell.seq.store(tail_ + CAPACITY, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+
+    // Кількість відкинутих записів з попереднього виклику.
+    uint32_t takeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+private:
+    static const uint32_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "MpscRing CAPACITY must be a power of two");
+
+    struct Cell {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+
+    Cell cells_[CAPACITY];
+    std::atomic<uint32_t> head_{0};
+    uint32_t tail_ = 0;
+    std::atomic<uint32_t> dropped_{0};
+};
@@ -0,0 +1,236 @@
+#include "obd_ecu.h"
+
+#include <string.h>
+
+void ObdEcu::begin(ObdHal &hal, uint8_t index) {
+    hal_ = &hal;
+    index_ = index;
+    cache_.begin(config.response_id, config.service01, config.service06, config.service09);
+    IsoTpSender::Hooks hooks = {isoTpTransmit, isoTpArmTimer, this};
+    isotp_.begin(config.response_id, hooks);
+}
+
+void ObdEcu::rebuildCache(const VehicleState &state) {
+    cache_.rebuild(state, config.owns_dtcs); // Інші ECU звітують "0 кодів"
+}
+
+void ObdEcu::onPhysicalFrame(const CanFrame &frame, uint32_t rx_us) {
+    if (frame.dlc > 0 && (frame.data[0] & 0xF0) == 0x30) {
+        hal_->lock(*this);
+        isotp_.onFlowControl(frame.data, frame.dlc, hal_->micros());
+        hal_->unlock(*this);
+        return;
+    }
+    handleRequest(frame, rx_us);
+}
+
+void ObdEcu::onFunctionalRequest(const CanFrame &frame, uint32_t rx_us) {
+    if (config.functional_delay_us == 0) {
+        handleRequest(frame, rx_us);
+        return;
+    }
+    hal_->lock(*this);
+    pendingRequest_ = frame;
+    pendingRxUs_ = rx_us;
+    hal_->unlock(*this);
+    hal_->armTimer(*this, OBD_TIMER_RESPONSE, config.functional_delay_us);
+}
+
+void ObdEcu::onTimer(ObdTimer timer) {
+    hal_->lock(*this);
+    if (timer == OBD_TIMER_ISOTP) {
+        isotp_.onTimer(hal_->micros());
+        hal_->unlock(*this);
+        return;
+    }
+    const CanFrame request = pendingRequest_;
+    const uint32_t rx_us = pendingRxUs_;
+    hal_->unlock(*this);
+    handleRequest(request, rx_us);
+}
+
+void ObdEcu::handleRequest(const CanFrame &frame, uint32_t rx_us) {
+    // Приймаємо лише Single Frame: PCI = 0x0N, де N - кількість байтів (сервіс + PID-и)
+    if (frame.dlc < 2) return;
+    uint8_t pci_len = frame.data[0] & 0x0F;
+    if ((frame.data[0] & 0xF0) != 0x00 || pci_len < 1 || pci_len > 7 || 1 + pci_len > frame.dlc) {
+        return;
+    }
+    uint8_t service = frame.data[1];
+    // Без PID/MID/InfoType (pci_len = 1) data[2] - лише заповнювач кадру
+    const bool has_pid = pci_len >= 2;
+    uint8_t pid = has_pid ? frame.data[2] : 0;
+
+    switch (service) {
+        case 0x01: sendCurrentData(&frame.data[2], pci_len - 1); break;
+        case 0x02: if (config.service02) sendFreezeFrame(&frame.data[2], (pci_len - 1) / 2); break;
+        case 0x03: {
+            DtcResponse response;
+            cache_.dtcs(response);
+            sendIsoTp(response.payload, response.len);
+            break;
+        }
+        case 0x04: clearDtcs(); break;
+        case 0x06: {
+            // Готова відповідь з кешу; понад один тест - багатокадрова
+            MonitorResponse response;
+            if (has_pid && cache_.service06(pid, response)) sendIsoTp(response.payload, response.len);
+            break;
+        }
+        case 0x09: if (has_pid) sendService09(pid); break;
+        case 0x0A: {
+            DtcResponse response;
+            cache_.permanentDtcs(response);
+            sendIsoTp(response.payload, response.len);
+            break;
+        }
+    }
+
+    // Затримка - від прийому кадру до передачі відповіді (першого кадру) у драйвер
+    log(EVT_OBD_REQUEST, hal_->micros() - rx_us, service, pid, pci_len - 1);
+}
+
+void ObdEcu::sendCurrentData(const uint8_t *pids, int count) {
+    CanFrame cached;
+
+    // Найчастіший випадок - один PID: готовий кадр з кешу
+    if (count == 1) {
+        if (cache_.service01(pids[0], cached)) {
+            hal_->transmit(cached, index_);
+        }
+        return;
+    }
+
+    // Відповідь: 0x41, далі для кожного підтримуваного PID - номер PID та його дані.
+    // Непідтримувані PID-и пропускаються; якщо не підтримується жоден - не відповідаємо.
+    uint8_t payload[1 + MAX_PIDS_PER_REQUEST * (1 + 4)];
+    int len = 0;
+    payload[len++] = 0x40 + 0x01; // Відповідь на сервіс 01
+
+    for (int i = 0; i < count && i < MAX_PIDS_PER_REQUEST; i++) {
+        if (!cache_.service01(pids[i], cached)) continue;
+        int pid_len = cached.data[0] - 1; // PID + дані
+        memcpy(&payload[len], &cached.data[2], pid_len);
+        len += pid_len;
+    }
+    if (len == 1) return;
+
+    sendIsoTp(payload, len);
+}
+
+void ObdEcu::sendFreezeFrame(const uint8_t *pairs, int count) {
+    // Кадр розгортається у знімок стану лише на запит: захоплення в addDTC() - просте копіювання
+    const VehicleState s = hal_->readState();
+    const int frames = config.owns_dtcs ? s.num_freeze_frames : 0;
+    VehicleState snapshot;
+    int restored = -1;
+
+    // Відповідь: 0x42, далі для кожної пари - PID, номер кадру та дані.
+    uint8_t payload[1 + MAX_FREEZE_FRAME_PIDS_PER_REQUEST * (2 + 4)];
+    int len = 0;
+    payload[len++] = 0x40 + 0x02; // Відповідь на сервіс 02
+
+    for (int i = 0; i < count && i < MAX_FREEZE_FRAME_PIDS_PER_REQUEST; i++) {
+        const uint8_t pid = pairs[i * 2];
+        const uint8_t frame = pairs[i * 2 + 1];
+        if (!config.service02->isSupported(pid)) continue;
+        // Маски та PID 0x02 (0000 - кадру немає) відповідають і без збереженого кадру
+        const bool always = isPidRangeQuery(pid) || pid == 0x02;
+        if (frame >= frames && !(always && frame == 0)) continue;
+
+        if (restored != frame) {
+            snapshot = VehicleState();
+            if (frame < frames) restoreFreezeFrame(s.freeze_frames[frame], snapshot);
+            restored = frame;
+        }
+        payload[len] = pid;
+        payload[len + 1] = frame;
+        len += 2 + config.service02->encode(pid, snapshot, &payload[len + 2]);
+    }
+    if (len == 1) return;
+
+    sendIsoTp(payload, len);
+}
+
+void ObdEcu::sendService09(uint8_t info_type) {
+    // Готова відповідь з кешу: довжина довільна, сегментує ISO-TP
+    uint8_t payload[MAX_INFO_RESPONSE];
+    size_t len = cache_.service09(info_type, payload);
+    if (len > 0) sendIsoTp(payload, len);
+}
+
+void ObdEcu::clearDtcs() {
+    if (config.owns_dtcs) {
+        hal_->clearDtcs(*this);
+    }
+    // Позитивна відповідь на сервіс 04 - незалежно від того, чи були в ECU коди
+    const uint8_t response = 0x40 + 0x04;
+    sendIsoTp(&response, 1);
+    log(EVT_DTCS_CLEARED, 0);
+}
+
+// Надсилає відповідь як Single Frame (до 7 байтів) або як First Frame + Consecutive Frames.
+void ObdEcu::sendIsoTp(const uint8_t *payload, size_t len) {
+    hal_->lock(*this);
+    bool ok = isotp_.send(payload, len, hal_->micros());
+    hal_->unlock(*this);
+    if (!ok) log(EVT_ISOTP_DROPPED, 0, payload[0] - 0x40, len > 1 ? payload[1] : 0, 0, len);
+}
+
+void ObdEcu::log(LogEventType type, uint32_t value, uint8_t service, uint8_t pid,
+                 uint8_t count, uint16_t length) {
+    LogEvent event = {};
+    event.timestamp_us = hal_->micros();
+    event.value = value;
+    event.length = length;
+    event.type = type;
+    event.ecu = index_;
+    event.service = service;
+    event.pid = pid;
+    event.count = count;
+    hal_->log(event);
+}
+
+bool ObdEcu::isoTpTransmit(void *ctx, const CanFrame &frame) {
+    ObdEcu *ecu = (ObdEcu *)ctx;
+    return ecu->hal_->transmit(frame, ecu->index_);
+}
+
+void ObdEcu::isoTpArmTimer(void *ctx, uint32_t delay_us) {
+    ObdEcu *ecu = (ObdEcu *)ctx;
+    ecu->hal_->armTimer(*ecu, OBD_TIMER_ISOTP, delay_us);
+}
+
+void dispatchObdFrame(ObdEcu *ecus, size_t count, const CanFrame &frame, uint32_t rx_us) {
+    if (frame.id == OBD_FUNCTIONAL_ID || frame.id == OBD_FUNCTIONAL_ID_29) {
+        for (size_t i = 0; i < count; i++) {
+            if (ecus[i].functionalId() == frame.id) ecus[i].onFunctionalRequest(frame, rx_us);
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (ecus[i].config.request_id == frame.id) {
+            ecus[i].onPhysicalFrame(frame, rx_us);
+            return;
+        }
+    }
+}
+
+CanFilterPlan planEcuFilter(const ObdEcu *ecus, size_t count) {
+    const size_t MAX_IDS = 2 * 16;
+    uint32_t ids[MAX_IDS];
+    size_t n = 0;
+    bool overflow = false;
+    auto addId = [&](uint32_t id) {
+        for (size_t i = 0; i < n; i++) {
+            if (ids[i] == id) return;
+        }
+        if (n < MAX_IDS) ids[n++] = id; else overflow = true;
+    };
+    for (size_t i = 0; i < count; i++) {
+        addId(ecus[i].config.request_id);
+        addId(ecus[i].functionalId());
+    }
+    // Забагато ID - краще пропускати все, ніж загубити запити до ECU
+    return planAcceptanceFilter(ids, overflow ? 0 : n);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_filter.h"
+#include "can_frame.h"
+#include "isotp.h"
+#include "obd_monitors.h"
+#include "obd_hal.h"
+#include "obd_pids.h"
+#include "response_cache.h"
+#include "obd_info.h"
+
+// ############## Віртуальні ECU ##############
+// Кожен ECU має власні фізичні CAN ID, набір PID сервісу 01 та стан протоколу
+// (ISO-TP сесію, відкладену відповідь). На функціональний запит (0x7DF) відповідають
+// усі ECU, кожен зі своєю затримкою - як у реальному авто, де ECM відповідає першим.
+// ISO 15765-4 допускає і 29-бітну адресацію: запит 0x18DA<ECU>F1, відповідь 0x18DAF1<ECU>,
+// функціональний 0x18DB33F1 (ID позначаються CAN_EXTENDED_FLAG, див. can_frame.h).
+const uint32_t OBD_FUNCTIONAL_ID = 0x7DF;
+const uint32_t OBD_FUNCTIONAL_ID_29 = 0x18DB33F1 | CAN_EXTENDED_FLAG;
+
+// SAE J1979: тестер може запитати до 6 PID сервісу 01 в одному кадрі
+const int MAX_PIDS_PER_REQUEST = 6;
+// Сервіс 02: пари (PID, номер кадру) - до 3 в одному кадрі
+const int MAX_FREEZE_FRAME_PIDS_PER_REQUEST = 3;
+
+struct ObdEcuConfig {
+    const char *name;
+    uint32_t request_id;          // Фізичний запит: 0x7E0..0x7E7 (або 0x18DA<ECU>F1)
+    uint32_t response_id;         // Відповідь: 0x7E8..0x7EF (або 0x18DAF1<ECU>)
+    const PidDispatch *service01;
+    const PidDispatch *service02; // Freeze frame; nullptr - сервіс 02 не підтримується
+    const MonitorTable *service06; // Тести моніторів; nullptr - сервіс 06 не підтримується
+    uint32_t functional_delay_us; // Затримка відповіді на 0x7DF
+    bool owns_dtcs;               // DTC з веб-інтерфейсу належать цьому ECU
+    const Service09Config *service09; // Ідентифікація; nullptr - сервіс 09 не підтримується
+};
+
+class ObdEcu {
+public:
+    ObdEcu(const ObdEcuConfig &config) : config(config) {}
+
+    // index - номер ECU у масиві: пріоритет передачі та поле ecu в журналі.
+    void begin(ObdHal &hal, uint8_t index);
+
+    // Перекодовує кеш відповідей зі знімка стану. Записувачі серіалізуються зовні.
+    void rebuildCache(const VehicleState &state);
+
+    // Фізичний кадр до цього ECU: запит (Single Frame) або Flow Control.
+    void onPhysicalFrame(const CanFrame &frame, uint32_t rx_us);
+    // Функціональний запит: відповідь одразу або через functional_delay_us.
+    void onFunctionalRequest(const CanFrame &frame, uint32_t rx_us);
+    void onTimer(ObdTimer timer);
+
+    uint32_t functionalId() const {
+        return isExtendedCanId(config.request_id) ? OBD_FUNCTIONAL_ID_29 : OBD_FUNCTIONAL_ID;
+    }
+    uint8_t index() const { return index_; }
+
+    const ObdEcuConfig config;
+
+private:
+    void handleRequest(const CanFrame &frame, uint32_t rx_us);
+    void sendCurrentData(const uint8_t *pids, int count);
+    void sendFreezeFrame(const uint8_t *pairs, int count);
+    void sendService09(uint8_t info_type);
+    void clearDtcs();
+    void sendIsoTp(const uint8_t *payload, size_t len);
+    void log(LogEventType type, uint32_t value, uint8_t service = 0, uint8_t pid = 0,
+             uint8_t count = 0, uint16_t length = 0);
+
+    static bool isoTpTransmit(void *ctx, const CanFrame &frame);
+    static void isoTpArmTimer(void *ctx, uint32_t delay_us);
+
+    ObdHal *hal_ = nullptr;
+    uint8_t index_ = 0;
+    ResponseCache cache_;
+    IsoTpSender isotp_;
+    CanFrame pendingRequest_ = {};
+    uint32_t pendingRxUs_ = 0;
+};
+
+// Функціональний запит отримують усі ECU того ж формату адресації,
+// фізичний - лише ECU з відповідним request_id (включно з Flow Control кадрами).
+void dispatchObdFrame(ObdEcu *ecus, size_t count, const CanFrame &frame, uint32_t rx_us);
+
+// Апаратний фільтр для всіх ID, на які відповідають ECU (див. can_filter.h).
+CanFilterPlan planEcuFilter(const ObdEcu *ecus, size_t count);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "can_frame.h"
+#include "event_log.h"
+#include "vehicle_state.h"
+
+class ObdEcu;
+
+enum ObdTimer : uint8_t {
+    OBD_TIMER_ISOTP,    // Наступний CF або таймаут FC
+    OBD_TIMER_RESPONSE, // Відкладена відповідь на функціональний запит
+};
+
+// ############## HAL ядра OBD ##############
+// Все, що ядру потрібно від платформи: час, передача кадрів, одноразові таймери,
+// м'ютекс на ECU та доступ до стану автомобіля. ESP32 реалізує його через TWAI,
+// esp_timer та FreeRTOS (src/main.cpp), тести - через фейк без потоків і реального часу.
+class ObdHal {
+public:
+    virtual ~ObdHal() {}
+
+    virtual uint32_t micros() = 0;
+
+    // Передає кадр без очікування. priority: 0 - найвищий. false - кадр відкинуто.
+    virtual bool transmit(const CanFrame &frame, uint8_t priority) = 0;
+
+    // Перезаводить одноразовий таймер; по спрацюванню платформа викликає ecu.onTimer(timer).
+    virtual void armTimer(ObdEcu &ecu, ObdTimer timer, uint32_t delay_us) = 0;
+
+    // Стан ISO-TP та відкладений запит ECU змінюються з різних задач (прийом, таймери).
+    virtual void lock(ObdEcu &ecu) = 0;
+    virtual void unlock(ObdEcu &ecu) = 0;
+
+    // Узгоджений знімок стану (сервіс 09).
+    virtual VehicleState readState() = 0;
+
+    // Сервіс 04 для ECU, якому належать DTC: платформа змінює стан і перебудовує кеші.
+    virtual void clearDtcs(ObdEcu &ecu) = 0;
+
+    virtual void log(const LogEvent &event) { (void)event; }
+};
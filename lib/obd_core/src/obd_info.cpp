@@ -0,0 +1,122 @@
+#include "obd_info.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Лише до термінатора: байти після нього не мають впливати на порівняння
+static void copyString(char *out, const char *value, size_t size) {
+    memcpy(out, value, strnlen(value, size - 1));
+}
+
+void readInfoInputs(const VehicleState &s, InfoInputs &out) {
+    memset(&out, 0, sizeof(out));
+    copyString(out.vin, s.vin, sizeof(out.vin));
+    copyString(out.cal_id, s.cal_id, sizeof(out.cal_id));
+    copyString(out.cvn, s.cvn, sizeof(out.cvn));
+    memcpy(out.ipt, s.ipt, sizeof(out.ipt));
+}
+
+size_t buildInfoResponse(uint8_t info_type, const uint8_t *items, uint8_t count, size_t item_len, uint8_t *out) {
+    out[0] = 0x40 + 0x09; // Відповідь на сервіс 09
+    out[1] = info_type;
+    out[2] = count;       // NODI
+    memcpy(&out[3], items, count * item_len);
+    return 3 + count * item_len;
+}
+
+// Рядок у поле фіксованої довжини, доповнене нулями
+static void putPadded(uint8_t *out, const char *value, size_t size) {
+    size_t len = value ? strnlen(value, size) : 0;
+    if (len > 0) memcpy(out, value, len);
+    memset(out + len, 0, size - len);
+}
+
+static void putU32(uint8_t *out, uint32_t value) {
+    out[0] = (value >> 24) & 0xFF;
+    out[1] = (value >> 16) & 0xFF;
+    out[2] = (value >> 8) & 0xFF;
+    out[3] = value & 0xFF;
+}
+
+static uint8_t calibrationCount(const Service09Config &config) {
+    int count = (config.state_identity ? 1 : 0) + config.num_calibrations;
+    return count > MAX_CALIBRATIONS ? MAX_CALIBRATIONS : count;
+}
+
+// Кількість 4-байтових повідомлень для протоколів без ISO-TP (InfoType 0x01, 0x03, ...)
+static uint8_t messageCount(size_t bytes) {
+    return (bytes + 3) / 4;
+}
+
+static bool isSupported(const Service09Config &config, uint8_t info_type) {
+    switch (info_type) {
+        case 0x00: return true;
+        case 0x01: case 0x02: return config.state_identity;
+        case 0x03: case 0x04: case 0x05: case 0x06: return calibrationCount(config) > 0;
+        case 0x07: return config.ipt != 0;
+        case 0x08: case 0x0B: return config.ipt == info_type;
+        case 0x09: case 0x0A: return config.ecu_acronym != nullptr;
+        case 0x0D: return config.esn != nullptr;
+    }
+    return false;
+}
+
+size_t encodeInfoType(const Service09Config &config, const InfoInputs &inputs, uint8_t info_type, uint8_t *out) {
+    if (info_type > MAX_INFO_TYPE || !isSupported(config, info_type)) return 0;
+    uint8_t items[CAL_ID_LEN * MAX_CALIBRATIONS];
+    const uint8_t cals = calibrationCount(config);
+
+    switch (info_type) {
+        case 0x00: {
+            uint32_t mask = 0;
+            for (int type = 1; type <= MAX_INFO_TYPE; type++) {
+                if (isSupported(config, type)) mask |= 1UL << (32 - type);
+            }
+            // Маска - без NODI
+            out[0] = 0x40 + 0x09;
+            out[1] = 0x00;
+            putU32(&out[2], mask);
+            return 6;
+        }
+        // Кількість повідомлень: саме число на місці NODI, без записів
+        case 0x01: return buildInfoResponse(info_type, items, messageCount(17), 0, out);
+        case 0x03: return buildInfoResponse(info_type, items, messageCount(CAL_ID_LEN * cals), 0, out);
+        case 0x05: return buildInfoResponse(info_type, items, cals, 0, out);
+        case 0x07: return buildInfoResponse(info_type, items, messageCount(IPT_COUNTERS * 2), 0, out);
+        case 0x09: return buildInfoResponse(info_type, items, messageCount(ECU_NAME_LEN), 0, out);
+        case 0x02:
+            putPadded(items, inputs.vin, 17);
+            return buildInfoResponse(info_type, items, 1, 17, out);
+        case 0x04:
+        case 0x06: {
+            const size_t item_len = info_type == 0x04 ? CAL_ID_LEN : 4;
+            for (int i = 0; i < cals; i++) {
+                // Перше калібрування - редаговане з веб-інтерфейсу (CVN там - hex-рядок)
+                const int extra = i - (config.state_identity ? 1 : 0);
+                uint8_t *item = &items[i * item_len];
+                if (info_type == 0x04) {
+                    putPadded(item, extra < 0 ? inputs.cal_id : config.calibrations[extra].cal_id, CAL_ID_LEN);
+                } else {
+                    putU32(item, extra < 0 ? strtoul(inputs.cvn, NULL, 16) : config.calibrations[extra].cvn);
+                }
+            }
+            return buildInfoResponse(info_type, items, cals, item_len, out);
+        }
+        case 0x08:
+        case 0x0B:
+            for (int i = 0; i < IPT_COUNTERS; i++) {
+                items[i * 2] = inputs.ipt[i] >> 8;
+                items[i * 2 + 1] = inputs.ipt[i] & 0xFF;
+            }
+            return buildInfoResponse(info_type, items, IPT_COUNTERS, 2, out);
+        case 0x0A:
+            putPadded(items, config.ecu_acronym, 4);
+            items[4] = '-';
+            putPadded(&items[5], config.ecu_name, ECU_NAME_LEN - 5);
+            return buildInfoResponse(info_type, items, 1, ECU_NAME_LEN, out);
+        case 0x0D:
+            putPadded(items, config.esn, ESN_LEN);
+            return buildInfoResponse(info_type, items, 1, ESN_LEN, out);
+    }
+    return 0;
+}
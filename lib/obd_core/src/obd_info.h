@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vehicle_state.h"
+
+// ############## Реєстр InfoType сервісу 09 ##############
+// Кожен InfoType на CAN (ISO 15765-4) має вигляд: 0x49, InfoType, NODI (кількість
+// записів), далі записи однакової довжини. Усі відповіді будує один генератор
+// (buildInfoResponse), а ISO-TP сегментує їх незалежно від довжини.
+// Відповіді серіалізуються в кеш (response_cache.h) лише коли змінюються
+// вхідні дані (VIN, CAL ID, CVN, лічильники IPT), а не на кожен запит.
+
+const int MAX_CALIBRATIONS = 4;
+const uint8_t MAX_INFO_TYPE = 0x0D;   // ESN
+const size_t CAL_ID_LEN = 16;
+const size_t ECU_NAME_LEN = 20;       // 4 (акронім) + '-' + 15 (назва)
+const size_t ESN_LEN = 16;
+const size_t MAX_INFO_RESPONSE = 3 + CAL_ID_LEN * MAX_CALIBRATIONS;
+
+// Незмінний запис калібрування: CAL ID (до 16 символів) та його CVN.
+struct Calibration {
+    const char *cal_id;
+    uint32_t cvn;
+};
+
+struct Service09Config {
+    bool state_identity;             // VIN (0x02) та перше калібрування - зі стану (веб-інтерфейс)
+    const Calibration *calibrations; // Власні калібрування ECU (після калібрування зі стану)
+    uint8_t num_calibrations;
+    uint8_t ipt;                     // 0x08 (іскрове запалювання), 0x0B (дизель) або 0 - без IPT
+    const char *ecu_acronym;         // 0x0A: до 4 символів, напр. "ECM"; nullptr - без назви
+    const char *ecu_name;            // 0x0A: до 15 символів
+    const char *esn;                 // 0x0D, nullptr - не підтримується
+};
+
+// Частина стану, з якої будуються відповіді. Заповнюється повністю (з нулями),
+// тож зміну можна виявити через memcmp.
+struct InfoInputs {
+    char vin[18];
+    char cal_id[17];
+    char cvn[9];
+    uint16_t ipt[IPT_COUNTERS];
+};
+
+void readInfoInputs(const VehicleState &s, InfoInputs &out);
+
+// Загальний генератор: 0x49, info_type, count, count записів по item_len байтів.
+// item_len = 0 - відповідь з одним числом (кількість повідомлень).
+size_t buildInfoResponse(uint8_t info_type, const uint8_t *items, uint8_t count, size_t item_len, uint8_t *out);
+
+// Записує відповідь на InfoType у out (до MAX_INFO_RESPONSE байтів) і повертає
+// її довжину; 0 - InfoType не підтримується.
+size_t encodeInfoType(const Service09Config &config, const InfoInputs &inputs, uint8_t info_type, uint8_t *out);
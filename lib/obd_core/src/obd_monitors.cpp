@@ -0,0 +1,53 @@
+#include "obd_monitors.h"
+
+static void putWord(uint8_t *out, uint16_t value) {
+    out[0] = value >> 8;
+    out[1] = value & 0xFF;
+}
+
+uint32_t supportedMidMask(const MonitorTable &table, int base) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < table.count; i++) {
+        const int mid = table.tests[i].mid;
+        if (mid > base && mid < base + 0x20) mask |= 1UL << (32 - (mid - base));
+        if (mid > base + 0x20) mask |= 1UL;
+    }
+    return mask;
+}
+
+bool isSupportedMid(const MonitorTable &table, uint8_t mid) {
+    if (isPidRangeQuery(mid)) return mid == 0x00 || (supportedMidMask(table, mid - 0x20) & 1UL);
+    for (size_t i = 0; i < table.count; i++) {
+        if (table.tests[i].mid == mid) return true;
+    }
+    return false;
+}
+
+size_t encodeMonitorResponse(const MonitorTable &table, uint8_t mid, const VehicleState &state, uint8_t *out) {
+    if (!isSupportedMid(table, mid)) return 0;
+    size_t len = 0;
+    out[len++] = 0x40 + 0x06; // Відповідь на сервіс 06
+
+    if (isPidRangeQuery(mid)) {
+        const uint32_t mask = supportedMidMask(table, mid);
+        out[len++] = mid;
+        out[len++] = (mask >> 24) & 0xFF;
+        out[len++] = (mask >> 16) & 0xFF;
+        out[len++] = (mask >> 8) & 0xFF;
+        out[len++] = mask & 0xFF;
+        return len;
+    }
+
+    for (size_t i = 0; i < table.count; i++) {
+        const MonitorTest &test = table.tests[i];
+        if (test.mid != mid) continue;
+        out[len++] = test.mid;
+        out[len++] = test.tid;
+        out[len++] = test.unit_scaling;
+        putWord(&out[len], test.value(state));
+        putWord(&out[len + 2], test.min);
+        putWord(&out[len + 4], test.max);
+        len += 6;
+    }
+    return len;
+}
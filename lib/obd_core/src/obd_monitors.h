@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "obd_pids.h"
+#include "vehicle_state.h"
+
+// ############## Реєстр тестів бортового моніторингу (сервіс 06) ##############
+// Кожен тест описується один раз: монітор (OBDMID), тест (TID), одиниці та
+// масштаб (UASID за SAE J1979 Appendix E), межі та функція значення зі знімка
+// стану. Відповідь на MID - це записи всіх його тестів по 9 байтів:
+// MID, TID, UASID, значення, мінімум, максимум (по 2 байти, старший першим).
+// Відповіді будуються при перебудові кешу (response_cache.h), а не на запит.
+
+const int MAX_TESTS_PER_MID = 8;
+const int MAX_MONITOR_MIDS = 16;     // Разом з MID-ами діапазону (0x00, 0x20, ...)
+const int MONITOR_RECORD_LEN = 9;
+
+// Сире значення тесту в одиницях UASID.
+typedef uint16_t (*MonitorValue)(const VehicleState &s);
+
+struct MonitorTest {
+    uint8_t mid;
+    uint8_t tid;
+    uint8_t unit_scaling; // UASID
+    uint16_t min;
+    uint16_t max;
+    MonitorValue value;
+};
+
+struct MonitorTable {
+    const MonitorTest *tests;
+    size_t count;
+};
+
+// Той самий формат маски, що й у PID сервісу 01 (див. supportedPidMask).
+uint32_t supportedMidMask(const MonitorTable &table, int base);
+
+// MID-и діапазону: 0x00 - завжди, решта - якщо попередня маска їх анонсує.
+bool isSupportedMid(const MonitorTable &table, uint8_t mid);
+
+// Записує відповідь на MID (0x46, записи тестів або маска діапазону) у out
+// і повертає її довжину; 0 - MID не підтримується.
+size_t encodeMonitorResponse(const MonitorTable &table, uint8_t mid, const VehicleState &state, uint8_t *out);
+
+// Тести згруповані за MID у порядку зростання, без MID-ів діапазону,
+// не більше MAX_TESTS_PER_MID на монітор і не більше MAX_MONITOR_MIDS загалом.
+template <size_t N>
+constexpr bool isValidMonitorTable(const MonitorTest (&table)[N]) {
+    int mids = 8; // Усі MID-и діапазону - із запасом
+    int tests_in_mid = 0;
+    for (size_t i = 0; i < N; i++) {
+        if (isPidRangeQuery(table[i].mid) || table[i].value == nullptr) return false;
+        if (i > 0 && table[i].mid < table[i - 1].mid) return false;
+        if (i > 0 && table[i].mid == table[i - 1].mid) {
+            if (table[i].tid <= table[i - 1].tid) return false;
+            if (++tests_in_mid > MAX_TESTS_PER_MID) return false;
+        } else {
+            tests_in_mid = 1;
+            mids++;
+        }
+    }
+    return mids <= MAX_MONITOR_MIDS;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vehicle_state.h"
+
+// ############## Реєстр PID сервісу 01 ##############
+// Кожен PID описується один раз: номер, кількість байтів даних та енкодер.
+// З цієї таблиці на етапі компіляції будуються бітові маски "Supported PIDs"
+// (0x00, 0x20, ... 0xE0) та таблиця диспетчеризації на 256 елементів,
+// тож маски не можуть розійтися з обробниками, а пошук PID має складність O(1).
+
+// Енкодер записує `length` байтів даних (A, B, C, D) зі знімка стану у out.
+typedef void (*PidEncoder)(const VehicleState &s, uint8_t *out);
+
+struct PidDescriptor {
+    uint8_t pid;
+    uint8_t length;     // Кількість байтів даних у відповіді (1..4)
+    PidEncoder encode;
+};
+
+struct PidSlot {
+    PidEncoder encode;  // nullptr для PID-ів діапазону (0x00, 0x20, ...)
+    uint8_t length;     // 0 -> PID не підтримується
+};
+
+struct PidDispatch {
+    PidSlot slot[256];
+    uint32_t supported[8]; // Маски для PID 0x00, 0x20, ... 0xE0
+
+    // Записує дані PID у out і повертає їх довжину, або 0 якщо PID не підтримується.
+    uint8_t encode(uint8_t pid, const VehicleState &state, uint8_t *out) const {
+        const PidSlot &s = slot[pid];
+        if (s.length == 0) return 0;
+        if (s.encode) {
+            s.encode(state, out);
+        } else {
+            const uint32_t mask = supported[pid >> 5];
+            out[0] = (mask >> 24) & 0xFF; // MSB -> PID base+1
+            out[1] = (mask >> 16) & 0xFF;
+            out[2] = (mask >> 8) & 0xFF;
+            out[3] = mask & 0xFF;         // LSB -> PID base+0x20
+        }
+        return s.length;
+    }
+
+    bool isSupported(uint8_t pid) const { return slot[pid].length != 0; }
+};
+
+constexpr bool isPidRangeQuery(uint8_t pid) { return (pid & 0x1F) == 0; }
+
+// Біт 31 (MSB) -> PID base+1, ..., біт 0 (LSB) -> PID base+0x20.
+// Біт base+0x20 встановлюється, якщо в таблиці є хоча б один PID вище цього діапазону.
+template <size_t N>
+constexpr uint32_t supportedPidMask(const PidDescriptor (&table)[N], int base) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < N; i++) {
+        const int pid = table[i].pid;
+        if (pid > base && pid < base + 0x20) mask |= 1UL << (32 - (pid - base));
+        if (pid > base + 0x20) mask |= 1UL;
+    }
+    return mask;
+}
+
+template <size_t N>
+constexpr bool isValidPidTable(const PidDescriptor (&table)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (isPidRangeQuery(table[i].pid)) return false; // Маски будуються автоматично
+        if (table[i].length < 1 || table[i].length > 4 || table[i].encode == nullptr) return false;
+        for (size_t j = i + 1; j < N; j++) {
+            if (table[i].pid == table[j].pid) return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr PidDispatch buildPidDispatch(const PidDescriptor (&table)[N]) {
+    PidDispatch d{};
+    for (int r = 0; r < 8; r++) {
+        d.supported[r] = supportedPidMask(table, r * 0x20);
+    }
+    // PID 0x00 підтримується завжди, решта масок - лише якщо попередня їх анонсує
+    for (int r = 0; r < 8; r++) {
+        if (r == 0 || (d.supported[r - 1] & 1UL)) {
+            d.slot[r * 0x20] = PidSlot{nullptr, 4};
+        }
+    }
+    for (size_t i = 0; i < N; i++) {
+        d.slot[table[i].pid] = PidSlot{table[i].encode, table[i].length};
+    }
+    return d;
+}
@@ -0,0 +1,130 @@
+#include "response_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void ResponseCache::begin(uint32_t response_id, const PidDispatch *service01, const MonitorTable *service06,
+                          const Service09Config *service09) {
+    responseId_ = response_id;
+    pids_ = service01;
+    monitors_ = service06;
+    info_ = service09;
+    infoBuilt_ = false;
+    // Набір MID-ів не змінюється - слоти розкладаються один раз
+    memset(midSlot_, NO_SLOT, sizeof(midSlot_));
+    numMids_ = 0;
+    for (int mid = 0; monitors_ && mid < 256; mid++) {
+        if (isSupportedMid(*monitors_, mid) && numMids_ < MAX_MONITOR_MIDS) midSlot_[mid] = numMids_++;
+    }
+    for (Bank &bank : banks_) {
+        bank.version.store(0);
+        memset(&bank.frames, 0, sizeof(bank.frames));
+    }
+    active_.store(0);
+}
+
+void ResponseCache::rebuild(const VehicleState &state, bool include_dtcs) {
+    const uint8_t target = active_.load(std::memory_order_relaxed) ^ 1;
+    Bank &bank = banks_[target];
+    bank.version.fetch_add(1, std::memory_order_acq_rel); // -> непарна
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int pid = 0; pid < 256; pid++) {
+        CanFrame &frame = bank.frames.service01[pid];
+        memset(&frame, 0, sizeof(frame));
+        uint8_t len = pids_->encode(pid, state, &frame.data[3]);
+        if (len == 0) continue;
+        frame.id = responseId_;
+        frame.data[0] = 2 + len;     // Length: 1 (service) + 1 (PID) + data
+        frame.data[1] = 0x40 + 0x01; // Відповідь на сервіс 01
+        frame.data[2] = pid;
+        frame.dlc = 1 + frame.data[0];
+    }
+    buildDtcResponse(bank.frames.dtcs, 0x43, state.dtcs, include_dtcs ? state.num_dtcs : 0);
+    buildDtcResponse(bank.frames.permanent_dtcs, 0x4A, state.permanent_dtcs, include_dtcs ? state.num_permanent_dtcs : 0);
+    for (int mid = 0; mid < 256; mid++) {
+        if (midSlot_[mid] == NO_SLOT) continue;
+        MonitorResponse &response = bank.frames.service06[midSlot_[mid]];
+        response.len = encodeMonitorResponse(*monitors_, mid, state, response.payload);
+    }
+
+    InfoInputs inputs;
+    readInfoInputs(state, inputs);
+    if (!infoBuilt_ || memcmp(&inputs, &infoInputs_, sizeof(inputs)) != 0) {
+        buildInfoResponses(bank.frames.service09, inputs);
+        infoInputs_ = inputs;
+        infoBuilt_ = true;
+    } else {
+        // Активний банк ніхто не змінює - копіюємо готові відповіді
+        bank.frames.service09 = banks_[target ^ 1].frames.service09;
+    }
+
+    bank.version.fetch_add(1, std::memory_order_release); // -> парна
+    active_.store(target, std::memory_order_release);
+}
+
+bool ResponseCache::service01(uint8_t pid, CanFrame &out) const {
+    read([&](const ResponseFrames &f) { out = f.service01[pid]; });
+    return out.dlc != 0;
+}
+
+void ResponseCache::dtcs(DtcResponse &out) const {
+    read([&](const ResponseFrames &f) { out = f.dtcs; });
+}
+
+void ResponseCache::permanentDtcs(DtcResponse &out) const {
+    read([&](const ResponseFrames &f) { out = f.permanent_dtcs; });
+}
+
+bool ResponseCache::service06(uint8_t mid, MonitorResponse &out) const {
+    if (midSlot_[mid] == NO_SLOT) return false;
+    read([&](const ResponseFrames &f) { out = f.service06[midSlot_[mid]]; });
+    return out.len != 0;
+}
+
+size_t ResponseCache::service09(uint8_t info_type, uint8_t *out) const {
+    if (info_type > MAX_INFO_TYPE) return 0;
+    size_t len = 0;
+    read([&](const ResponseFrames &f) {
+        len = f.service09.len[info_type];
+        memcpy(out, &f.service09.data[f.service09.offset[info_type]], len);
+    });
+    return len;
+}
+
+void ResponseCache::buildInfoResponses(InfoResponses &responses, const InfoInputs &inputs) const {
+    memset(&responses, 0, sizeof(responses));
+    if (!info_) return;
+    size_t used = 0;
+    for (uint8_t type = 0; type <= MAX_INFO_TYPE; type++) {
+        uint8_t response[MAX_INFO_RESPONSE];
+        size_t len = encodeInfoType(*info_, inputs, type, response);
+        if (len == 0 || used + len > sizeof(responses.data)) continue;
+        memcpy(&responses.data[used], response, len);
+        responses.offset[type] = used;
+        responses.len[type] = len;
+        used += len;
+    }
+}
+
+void ResponseCache::buildDtcResponse(DtcResponse &response, uint8_t response_service, const char (*codes)[6], int count) {
+    if (count > MAX_DTCS) count = MAX_DTCS;
+    response.payload[0] = response_service;
+    response.payload[1] = count;
+    for (int i = 0; i < count; i++) {
+        encodeDtc(codes[i], &response.payload[2 + i * 2]);
+    }
+    response.len = 2 + count * 2;
+}
+
+void encodeDtc(const char *code, uint8_t *out) {
+    // Цифри DTC - це шістнадцяткові тетради: "P0300" -> 0x03 0x00
+    long code_val = strtol(&code[1], NULL, 16);
+    uint8_t b1 = (code_val >> 8) & 0x3F;
+    uint8_t b2 = code_val & 0xFF;
+    if (code[0] == 'C') b1 |= 0x40;
+    else if (code[0] == 'B') b1 |= 0x80;
+    else if (code[0] == 'U') b1 |= 0xC0;
+    out[0] = b1;
+    out[1] = b2;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include "can_frame.h"
+#include "obd_monitors.h"
+#include "obd_pids.h"
+#include "obd_info.h"
+#include "vehicle_state.h"
+
+// ############## Кеш готових CAN-відповідей ##############
+// Для кожного ECU зберігаються готові до відправки кадри: Single Frame на кожен
+// PID сервісу 01, відповіді сервісів 03 та 0A. Кеш перебудовується лише коли
+// змінюються дані (веб /update, симуляція, DTC), тож CAN-шлях зводиться до
+// пошуку кадру та передачі. Відповіді 03/0A, 06 (по одній на MID) та 09 зберігаються
+// як готовий ISO-TP payload, бо вони не вміщаються в Single Frame. Відповіді 09
+// перекодовуються лише при зміні їхніх вхідних даних, інакше копіюються з активного банку.
+//
+// Два банки: запис іде в неактивний, потім він стає активним. Читач копіює кадр
+// і перевіряє версію банку, тож ніколи не бачить напівзаписаних даних.
+// Записувачі мають бути серіалізовані зовні (одночасно лише один).
+
+struct DtcResponse {
+    uint8_t len;
+    uint8_t payload[2 + 2 * MAX_DTCS]; // 0x43/0x4A, кількість, по 2 байти на DTC
+};
+
+struct MonitorResponse {
+    uint8_t len;
+    uint8_t payload[1 + MAX_TESTS_PER_MID * MONITOR_RECORD_LEN]; // 0x46, записи тестів
+};
+
+struct InfoResponses {
+    uint16_t offset[MAX_INFO_TYPE + 1];
+    uint8_t len[MAX_INFO_TYPE + 1]; // 0 -> InfoType не підтримується
+    uint8_t data[256];              // Відповіді всіх InfoType підряд
+};
+
+struct ResponseFrames {
+    CanFrame service01[256];       // dlc = 0 -> PID не підтримується
+    DtcResponse dtcs;              // Mode 03
+    DtcResponse permanent_dtcs;    // Mode 0A
+    MonitorResponse service06[MAX_MONITOR_MIDS]; // Mode 06, індекс - слот MID
+    InfoResponses service09;       // Mode 09
+};
+
+class ResponseCache {
+public:
+    // service06 / service09 = nullptr -> сервіс не підтримується.
+    void begin(uint32_t response_id, const PidDispatch *service01, const MonitorTable *service06,
+               const Service09Config *service09);
+
+    // Перекодовує всі PID та DTC-кадри зі знімка стану в неактивний банк і публікує його.
+    // include_dtcs = false -> ECU звітує "0 кодів".
+    void rebuild(const VehicleState &state, bool include_dtcs);
+
+    // Копіює кадр відповіді на PID; false, якщо PID не підтримується.
+    bool service01(uint8_t pid, CanFrame &out) const;
+    void dtcs(DtcResponse &out) const;
+    void permanentDtcs(DtcResponse &out) const;
+    // Копіює відповідь на MID сервісу 06; false, якщо MID не підтримується.
+    bool service06(uint8_t mid, MonitorResponse &out) const;
+    // Копіює відповідь на InfoType (до MAX_INFO_RESPONSE байтів) і повертає її довжину; 0 - не підтримується.
+    size_t service09(uint8_t info_type, uint8_t *out) const;
+
+private:
+    struct Bank {
+        std::atomic<uint32_t> version; // Непарна - банк саме перезаписується
+        ResponseFrames frames;
+    };
+
+    template <typename Fn>
+    void read(Fn copy) const {
+        for (;;) {
+            const Bank &bank = banks_[active_.load(std::memory_order_acquire)];
+            uint32_t v = bank.version.load(std::memory_order_acquire);
+            if (v & 1) continue;
+            copy(bank.frames);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (bank.version.load(std::memory_order_relaxed) == v) return;
+        }
+    }
+
+    void buildInfoResponses(InfoResponses &responses, const InfoInputs &inputs) const;
+    static void buildDtcResponse(DtcResponse &response, uint8_t response_service, const char (*codes)[6], int count);
+
+    uint32_t responseId_ = 0;
+    const PidDispatch *pids_ = nullptr;
+    const MonitorTable *monitors_ = nullptr;
+    uint8_t midSlot_[256];   // MID -> індекс у service06, NO_SLOT - не підтримується
+    uint8_t numMids_ = 0;
+    static const uint8_t NO_SLOT = 0xFF;
+    const Service09Config *info_ = nullptr;
+    InfoInputs infoInputs_;  // Вхідні дані останньої серіалізації сервісу 09
+    bool infoBuilt_ = false;
+    Bank banks_[2];
+    std::atomic<uint8_t> active_{0};
+};
+
+// "P0123" -> 2 байти за SAE J2012 (P=00, C=01, B=10, U=11 у старших бітах).
+void encodeDtc(const char *code, uint8_t *out);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+// ############## SeqLock ##############
+// Публікація невеликої структури без м'ютекса для читачів: записувач робить
+// лічильник непарним, копіює дані та робить його знову парним; читач копіює
+// дані та повторює спробу, якщо лічильник був непарним або змінився.
+// Записувачі мають бути серіалізовані зовні. T має бути trivially copyable.
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : value_() {}
+
+    T read() const {
+        T copy;
+        for (;;) {
+            uint32_t seq = seq_.load(std::memory_order_acquire);
+            if (seq & 1) continue;
+            memcpy(&copy, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == seq) return copy;
+        }
+    }
+
+    void write(const T &value) {
+        seq_.fetch_add(1, std::memory_order_relaxed); // -> непарний
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value_, &value, sizeof(T));
+        seq_.fetch_add(1, std::memory_order_release); // -> парний
+    }
+
+private:
+    std::atomic<uint32_t> seq_{0};
+    T value_;
+};
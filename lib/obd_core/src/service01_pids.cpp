@@ -0,0 +1,142 @@
+#include "service01_pids.h"
+
+#include "response_cache.h"
+
+namespace {
+
+uint8_t clampByte(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+void putWord(uint8_t *out, int value) {
+    out[0] = (value >> 8) & 0xFF;
+    out[1] = value & 0xFF;
+}
+
+// ############## Енкодери PID сервісу 01 ##############
+void encodeMonitorStatus(const VehicleState &s, uint8_t *out) {
+    // Byte A: Bit 7 = MIL Status, Bits 0-6 = DTC Count
+    uint8_t mil_dtc_count = s.num_dtcs & 0x7F;
+    if (s.num_dtcs > 0) {
+        mil_dtc_count |= 0x80; // Set MIL ON
+    }
+    out[0] = mil_dtc_count;
+    out[1] = 0x00; // Byte B (Tests supported/complete - simplified)
+    out[2] = 0x00; // Byte C
+    out[3] = 0x00; // Byte D
+}
+
+void encodeCoolantTemp(const VehicleState &s, uint8_t *out) {
+    // Формула: A-40
+    out[0] = s.engine_temp + 40;
+}
+
+void encodeFuelPressure(const VehicleState &s, uint8_t *out) {
+    // Формула: A * 3 (kPa) -> A = val / 3
+    out[0] = clampByte(s.fuel_pressure / 3);
+}
+
+void encodeEngineRpm(const VehicleState &s, uint8_t *out) {
+    // Формула: (A*256+B)/4
+    putWord(out, s.engine_rpm * 4);
+}
+
+void encodeVehicleSpeed(const VehicleState &s, uint8_t *out) {
+    // Формула: A
+    out[0] = s.vehicle_speed;
+}
+
+void encodeTimingAdvance(const VehicleState &s, uint8_t *out) {
+    // Формула: (A-128)/2 => A = (val * 2) + 128
+    out[0] = clampByte((int)((s.timing_advance * 2) + 128));
+}
+
+void encodeMafRate(const VehicleState &s, uint8_t *out) {
+    // Формула: (A*256+B)/100
+    putWord(out, (int)(s.maf_rate * 100));
+}
+
+void encodeFuelLevel(const VehicleState &s, uint8_t *out) {
+    // Формула: 100/255 * A
+    out[0] = (s.fuel_level * 255.0) / 100.0;
+}
+
+void encodeDistanceWithMil(const VehicleState &s, uint8_t *out) {
+    // Формула: A*256 + B
+    putWord(out, s.distance_with_mil);
+}
+
+void encodeFuelRate(const VehicleState &s, uint8_t *out) {
+    // Формула: ((A*256)+B)/20 L/h => val = rate * 20
+    putWord(out, (int)(s.fuel_rate * 20));
+}
+
+void encodeFreezeFrameDtc(const VehicleState &s, uint8_t *out) {
+    // Сервіс 02: DTC, що спричинив кадр (див. restoreFreezeFrame); 0000 - кадру немає
+    if (s.num_dtcs > 0) {
+        encodeDtc(s.dtcs[0], out);
+    } else {
+        out[0] = 0x00;
+        out[1] = 0x00;
+    }
+}
+
+void encodeTcmMonitorStatus(const VehicleState &, uint8_t *out) {
+    // TCM не зберігає DTC: MIL вимкнено, 0 кодів
+    out[0] = 0x00;
+    out[1] = 0x00;
+    out[2] = 0x00;
+    out[3] = 0x00;
+}
+
+void encodeTransmissionGear(const VehicleState &s, uint8_t *out) {
+    // A: біт 1 = дані підтримуються; (C*256+D)/1000 = передаточне число
+    static const int GEAR_RATIOS[] = {0, 3538, 2060, 1404, 1000, 713, 582}; // x1000
+    int gear = s.transmission_gear < 0 ? 0 : (s.transmission_gear > 6 ? 6 : s.transmission_gear);
+    out[0] = 0x02;
+    out[1] = 0x00;
+    putWord(&out[2], GEAR_RATIOS[gear]);
+}
+
+// Маски "Supported PIDs" (0x00, 0x20, 0x40 ...) будуються з цих таблиць автоматично.
+constexpr PidDescriptor SERVICE01_PIDS[] = {
+    {0x01, 4, encodeMonitorStatus},   // Monitor status since DTCs cleared
+    {0x05, 1, encodeCoolantTemp},     // Engine Coolant Temperature
+    {0x0A, 1, encodeFuelPressure},    // Fuel Pressure
+    {0x0C, 2, encodeEngineRpm},       // Engine RPM
+    {0x0D, 1, encodeVehicleSpeed},    // Vehicle Speed
+    {0x0E, 1, encodeTimingAdvance},   // Timing Advance
+    {0x10, 2, encodeMafRate},         // MAF air flow rate
+    {0x2F, 1, encodeFuelLevel},       // Fuel Tank Level Input
+    {0x31, 2, encodeDistanceWithMil}, // Distance Traveled with MIL On
+    {0x5E, 2, encodeFuelRate},        // Engine Fuel Rate
+};
+static_assert(isValidPidTable(SERVICE01_PIDS), "SERVICE01_PIDS: duplicate, range or malformed PID entry");
+
+// Freeze frame: ті самі енкодери, але без статусу моніторів (він не зберігається в кадрі)
+constexpr PidDescriptor SERVICE02_PIDS[] = {
+    {0x02, 2, encodeFreezeFrameDtc},  // DTC that caused freeze frame
+    {0x05, 1, encodeCoolantTemp},     // Engine Coolant Temperature
+    {0x0A, 1, encodeFuelPressure},    // Fuel Pressure
+    {0x0C, 2, encodeEngineRpm},       // Engine RPM
+    {0x0D, 1, encodeVehicleSpeed},    // Vehicle Speed
+    {0x0E, 1, encodeTimingAdvance},   // Timing Advance
+    {0x10, 2, encodeMafRate},         // MAF air flow rate
+    {0x2F, 1, encodeFuelLevel},       // Fuel Tank Level Input
+    {0x31, 2, encodeDistanceWithMil}, // Distance Traveled with MIL On
+    {0x5E, 2, encodeFuelRate},        // Engine Fuel Rate
+};
+static_assert(isValidPidTable(SERVICE02_PIDS), "SERVICE02_PIDS: duplicate, range or malformed PID entry");
+
+constexpr PidDescriptor TCM_SERVICE01_PIDS[] = {
+    {0x01, 4, encodeTcmMonitorStatus}, // Monitor status since DTCs cleared
+    {0x0D, 1, encodeVehicleSpeed},     // Vehicle Speed
+    {0xA4, 4, encodeTransmissionGear}, // Transmission Actual Gear
+};
+static_assert(isValidPidTable(TCM_SERVICE01_PIDS), "TCM_SERVICE01_PIDS: duplicate, range or malformed PID entry");
+
+} // namespace
+
+constexpr PidDispatch SERVICE01 = buildPidDispatch(SERVICE01_PIDS);
+constexpr PidDispatch SERVICE02 = buildPidDispatch(SERVICE02_PIDS);
+constexpr PidDispatch TCM_SERVICE01 = buildPidDispatch(TCM_SERVICE01_PIDS);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "obd_pids.h"
+
+// ############## PID сервісів 01 та 02 емульованих ECU ##############
+// Таблиці диспетчеризації будуються на етапі компіляції (див. obd_pids.h).
+// Сервіс 02 (freeze frame) використовує ті самі енкодери над знімком з restoreFreezeFrame().
+
+extern const PidDispatch SERVICE01;     // ECM
+extern const PidDispatch SERVICE02;     // ECM, freeze frame
+extern const PidDispatch TCM_SERVICE01; // TCM
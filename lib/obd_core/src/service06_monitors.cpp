@@ -0,0 +1,97 @@
+#include "service06_monitors.h"
+
+#include <string.h>
+
+namespace {
+
+// UASID (SAE J1979 Appendix E)
+const uint8_t UAS_MILLIVOLTS = 0x0A; // 0.122 mV на біт
+const uint8_t UAS_MS = 0x10;         // 1 мс на біт
+const uint8_t UAS_RAW = 0x01;        // Без одиниць, 1 на біт
+const uint8_t UAS_COUNTS = 0x24;     // Лічильник подій
+
+constexpr uint16_t millivolts(int mv) {
+    return (uint16_t)(mv * 1000 / 122);
+}
+
+uint16_t clampWord(int value) {
+    return value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
+}
+
+// Пропуски запалювання за поточний цикл на один циліндр (P0300 - по всіх рівномірно)
+int misfiresPerCylinder(const VehicleState &s) {
+    if (!s.misfire_simulation_enabled || s.engine_rpm <= 3500) return 0;
+    return 20 + (s.engine_rpm - 3500) / 50;
+}
+
+bool hasCurrentDtc(const VehicleState &s, const char *code) {
+    for (int i = 0; i < s.num_dtcs; i++) {
+        if (strcmp(s.dtcs[i], code) == 0) return true;
+    }
+    return false;
+}
+
+// ############## Значення тестів ##############
+uint16_t o2ThresholdVoltage(const VehicleState &) {
+    return millivolts(450);
+}
+
+uint16_t o2SwitchTime(const VehicleState &s) {
+    // Бідна суміш: датчик довго "висить" внизу
+    return s.lean_mixture_simulation_enabled ? 180 : 60;
+}
+
+uint16_t o2MinVoltage(const VehicleState &s) {
+    return millivolts(s.lean_mixture_simulation_enabled ? 40 : 80);
+}
+
+uint16_t o2MaxVoltage(const VehicleState &s) {
+    return millivolts(s.lean_mixture_simulation_enabled ? 380 : 820);
+}
+
+uint16_t catalystStorage(const VehicleState &s) {
+    // Відношення сигналів датчиків до/після каталізатора: пропуски його перегрівають
+    return hasCurrentDtc(s, "P0300") ? 0x02A0 : 0x00C0;
+}
+
+uint16_t misfireCylinder(const VehicleState &s) {
+    return clampWord(misfiresPerCylinder(s));
+}
+
+uint16_t misfireCylinderAverage(const VehicleState &s) {
+    // EWMA за останні 10 циклів: збережений P0300 тримає середнє високим
+    int current = misfiresPerCylinder(s);
+    return clampWord(current > 0 ? current / 2 : (hasCurrentDtc(s, "P0300") ? 8 : 0));
+}
+
+uint16_t misfireTotal(const VehicleState &s) {
+    return clampWord(misfireCylinder(s) * 4);
+}
+
+uint16_t misfireTotalAverage(const VehicleState &s) {
+    return clampWord(misfireCylinderAverage(s) * 4);
+}
+
+constexpr MonitorTest SERVICE06_TESTS[] = {
+    // MID  TID   UASID           min               max               value
+    {0x01, 0x01, UAS_MILLIVOLTS, millivolts(400),  millivolts(500),  o2ThresholdVoltage},     // O2 B1S1: rich->lean threshold
+    {0x01, 0x05, UAS_MS,         0,                120,              o2SwitchTime},           // O2 B1S1: rich->lean switch time
+    {0x01, 0x07, UAS_MILLIVOLTS, 0,                millivolts(200),  o2MinVoltage},           // O2 B1S1: min voltage
+    {0x01, 0x08, UAS_MILLIVOLTS, millivolts(600),  millivolts(1000), o2MaxVoltage},           // O2 B1S1: max voltage
+    {0x21, 0x80, UAS_RAW,        0,                0x0200,           catalystStorage},        // Catalyst B1 (manufacturer TID)
+    {0xA1, 0x0B, UAS_COUNTS,     0,                0x00A0,           misfireTotalAverage},    // Misfire general: EWMA 10 cycles
+    {0xA1, 0x0C, UAS_COUNTS,     0,                0x00A0,           misfireTotal},           // Misfire general: current cycle
+    {0xA2, 0x0B, UAS_COUNTS,     0,                0x0028,           misfireCylinderAverage}, // Cylinder 1
+    {0xA2, 0x0C, UAS_COUNTS,     0,                0x0028,           misfireCylinder},
+    {0xA3, 0x0B, UAS_COUNTS,     0,                0x0028,           misfireCylinderAverage}, // Cylinder 2
+    {0xA3, 0x0C, UAS_COUNTS,     0,                0x0028,           misfireCylinder},
+    {0xA4, 0x0B, UAS_COUNTS,     0,                0x0028,           misfireCylinderAverage}, // Cylinder 3
+    {0xA4, 0x0C, UAS_COUNTS,     0,                0x0028,           misfireCylinder},
+    {0xA5, 0x0B, UAS_COUNTS,     0,                0x0028,           misfireCylinderAverage}, // Cylinder 4
+    {0xA5, 0x0C, UAS_COUNTS,     0,                0x0028,           misfireCylinder},
+};
+static_assert(isValidMonitorTable(SERVICE06_TESTS), "SERVICE06_TESTS: unsorted, range or malformed MID entry");
+
+} // namespace
+
+const MonitorTable SERVICE06 = {SERVICE06_TESTS, sizeof(SERVICE06_TESTS) / sizeof(SERVICE06_TESTS[0])};
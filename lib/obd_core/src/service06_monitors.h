@@ -0,0 +1,8 @@
+#pragma once
+
+#include "obd_monitors.h"
+
+// ############## Тести моніторів сервісу 06 емульованих ECU ##############
+// Значення рахуються зі знімка стану (симуляція пропусків запалювання та бідної суміші).
+
+extern const MonitorTable SERVICE06; // ECM
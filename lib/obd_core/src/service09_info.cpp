@@ -0,0 +1,25 @@
+#include "service09_info.h"
+
+namespace {
+
+const Calibration ECM_CALIBRATIONS[] = {
+    {"EMU_ECM_BOOT_01", 0x5A3C0F11}, // Завантажувач ECM
+};
+
+const Calibration TCM_CALIBRATIONS[] = {
+    {"EMU_TCM_CAL_0042", 0x0F1E2D3C},
+};
+
+} // namespace
+
+const Service09Config SERVICE09 = {
+    true, ECM_CALIBRATIONS, sizeof(ECM_CALIBRATIONS) / sizeof(ECM_CALIBRATIONS[0]),
+    0x08, // IPT для двигуна з іскровим запалюванням
+    "ECM", "EngineControl", "EMU0000000000001",
+};
+
+const Service09Config TCM_SERVICE09 = {
+    false, TCM_CALIBRATIONS, sizeof(TCM_CALIBRATIONS) / sizeof(TCM_CALIBRATIONS[0]),
+    0,
+    "TCM", "TransmissionCtl", nullptr,
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "obd_info.h"
+
+// ############## Ідентифікація емульованих ECU (сервіс 09) ##############
+// VIN та перше калібрування ECM редагуються з веб-інтерфейсу, решта - незмінна.
+
+extern const Service09Config SERVICE09;     // ECM
+extern const Service09Config TCM_SERVICE09; // TCM
@@ -0,0 +1,134 @@
+#include "state_json.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+class JsonWriter {
+public:
+    JsonWriter(char *out, size_t size) : out_(out), size_(size) {}
+
+    void raw(const char *fmt, ...) {
+        if (overflow_) return;
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(out_ + len_, size_ - len_, fmt, args);
+        va_end(args);
+        if (n < 0 || (size_t)n >= size_ - len_) {
+            overflow_ = true;
+        } else {
+            len_ += n;
+        }
+    }
+
+    void put(char c) {
+        if (overflow_ || len_ + 1 >= size_) {
+            overflow_ = true;
+            return;
+        }
+        out_[len_++] = c;
+        out_[len_] = '\0';
+    }
+
+    // "name": - з комою перед усіма полями, крім першого
+    void key(const char *name) { raw(fields_++ ? ",\"%s\":" : "\"%s\":", name); }
+
+    void string(const char *value, size_t max_len) {
+        put('"');
+        for (size_t i = 0; i < max_len && value[i]; i++) {
+            const unsigned char c = value[i];
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (c < 0x20) {
+                raw("\\u%04x", c);
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    void dtcList(const char (*codes)[6], int count) {
+        put('[');
+        for (int i = 0; i < count && i < MAX_DTCS; i++) {
+            if (i) put(',');
+            string(codes[i], 5);
+        }
+        put(']');
+    }
+
+    int fields() const { return fields_; }
+    size_t finish() { return overflow_ ? 0 : len_; }
+
+private:
+    char *out_;
+    size_t size_;
+    size_t len_ = 0;
+    int fields_ = 0;
+    bool overflow_ = false;
+};
+
+bool sameDtcs(const char (*a)[6], int count_a, const char (*b)[6], int count_b) {
+    if (count_a != count_b) return false;
+    for (int i = 0; i < count_a && i < MAX_DTCS; i++) {
+        if (strncmp(a[i], b[i], 6) != 0) return false;
+    }
+    return true;
+}
+
+// Однакові з точністю, яку показує сторінка: інакше дрібний шум генерує зайві дельти
+bool sameRounded(float a, float b, float scale) {
+    return lroundf(a * scale) == lroundf(b * scale);
+}
+
+} // namespace
+
+size_t writeStateJson(const VehicleState &s, const VehicleState *prev, char *out, size_t size) {
+    if (size == 0) return 0;
+    JsonWriter w(out, size);
+    const VehicleState *p = prev;
+    w.put('{');
+
+    if (!p || strncmp(s.vin, p->vin, sizeof(s.vin)) != 0) { w.key("vin"); w.string(s.vin, sizeof(s.vin)); }
+    if (!p || strncmp(s.cal_id, p->cal_id, sizeof(s.cal_id)) != 0) { w.key("cal_id"); w.string(s.cal_id, sizeof(s.cal_id)); }
+    if (!p || strncmp(s.cvn, p->cvn, sizeof(s.cvn)) != 0) { w.key("cvn"); w.string(s.cvn, sizeof(s.cvn)); }
+    if (!p || s.engine_rpm != p->engine_rpm) { w.key("rpm"); w.raw("%d", s.engine_rpm); }
+    if (!p || s.engine_temp != p->engine_temp) { w.key("temp"); w.raw("%d", s.engine_temp); }
+    if (!p || s.vehicle_speed != p->vehicle_speed) { w.key("speed"); w.raw("%d", s.vehicle_speed); }
+    if (!p || !sameRounded(s.maf_rate, p->maf_rate, 100)) { w.key("maf"); w.raw("%.2f", s.maf_rate); }
+    if (!p || !sameRounded(s.timing_advance, p->timing_advance, 10)) { w.key("timing"); w.raw("%.1f", s.timing_advance); }
+    if (!p || !sameRounded(s.fuel_rate, p->fuel_rate, 100)) { w.key("fuel_rate"); w.raw("%.2f", s.fuel_rate); }
+    if (!p || s.fuel_pressure != p->fuel_pressure) { w.key("fuel_pressure"); w.raw("%d", s.fuel_pressure); }
+    if (!p || !sameRounded(s.fuel_level, p->fuel_level, 10)) { w.key("fuel"); w.raw("%.1f", s.fuel_level); }
+    if (!p || s.distance_with_mil != p->distance_with_mil) { w.key("dist_mil"); w.raw("%d", s.distance_with_mil); }
+    if (!p || !sameRounded(s.battery_voltage, p->battery_voltage, 10)) { w.key("voltage"); w.raw("%.1f", s.battery_voltage); }
+    if (!p || s.error_free_cycles != p->error_free_cycles) { w.key("cycles"); w.raw("%d", s.error_free_cycles); }
+    if (!p || s.dynamic_rpm_enabled != p->dynamic_rpm_enabled) {
+        w.key("dynamic_rpm");
+        w.raw(s.dynamic_rpm_enabled ? "true" : "false");
+    }
+    if (!p || s.misfire_simulation_enabled != p->misfire_simulation_enabled) {
+        w.key("misfire_sim");
+        w.raw(s.misfire_simulation_enabled ? "true" : "false");
+    }
+    if (!p || s.lean_mixture_simulation_enabled != p->lean_mixture_simulation_enabled) {
+        w.key("lean_mixture_sim");
+        w.raw(s.lean_mixture_simulation_enabled ? "true" : "false");
+    }
+    if (!p || !sameDtcs(s.dtcs, s.num_dtcs, p->dtcs, p->num_dtcs)) {
+        w.key("dtcs");
+        w.dtcList(s.dtcs, s.num_dtcs);
+    }
+    if (!p || !sameDtcs(s.permanent_dtcs, s.num_permanent_dtcs, p->permanent_dtcs, p->num_permanent_dtcs)) {
+        w.key("permanent_dtcs");
+        w.dtcList(s.permanent_dtcs, s.num_permanent_dtcs);
+    }
+
+    if (w.fields() == 0) return 0;
+    w.put('}');
+    return w.finish();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "vehicle_state.h"
+
+// ############## Стан для веб-інтерфейсу (JSON) ##############
+// Ключовий кадр - усі поля; дельта - лише поля, що змінилися відносно
+// попередньо надісланого стану (дробові - з точністю, яку показує сторінка).
+// Сторінка зливає дельти в накопичений стан (onMessage у web/app.js).
+
+// Достатньо для найгіршого випадку: усі рядки з екрануванням \u00XX, 5 + 5 DTC.
+const size_t STATE_JSON_MAX = 1024;
+
+// prev == nullptr - ключовий кадр. Повертає довжину без завершального нуля;
+// 0 - змін немає (дельта) або буфер замалий.
+size_t writeStateJson(const VehicleState &s, const VehicleState *prev, char *out, size_t size);
@@ -0,0 +1,66 @@
+#include "telemetry.h"
+
+#include <string.h>
+
+#include "response_cache.h"
+
+static void putU16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static void putU32(uint8_t *out, uint32_t value) {
+    putU16(out, value & 0xFFFF);
+    putU16(out + 2, value >> 16);
+}
+
+static void putF32(uint8_t *out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putU32(out, bits);
+}
+
+static void putString(uint8_t *out, const char *value, size_t size) {
+    size_t len = strnlen(value, size);
+    memcpy(out, value, len);
+    memset(out + len, 0, size - len);
+}
+
+static void putDtcs(uint8_t *out, const char (*codes)[6], int count) {
+    for (int i = 0; i < MAX_DTCS; i++) {
+        uint8_t code[2] = {0, 0};
+        if (i < count) encodeDtc(codes[i], code);
+        putU16(out + i * 2, (code[0] << 8) | code[1]);
+    }
+}
+
+static uint16_t clampU16(int value) {
+    return value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
+}
+
+void encodeTelemetry(const VehicleState &s, uint8_t *out) {
+    out[0] = TELEMETRY_SCHEMA;
+    out[1] = (s.dynamic_rpm_enabled ? TELEMETRY_DYNAMIC_RPM : 0) |
+             (s.misfire_simulation_enabled ? TELEMETRY_MISFIRE_SIM : 0) |
+             (s.lean_mixture_simulation_enabled ? TELEMETRY_LEAN_MIXTURE_SIM : 0);
+    out[2] = s.num_dtcs;
+    out[3] = s.num_permanent_dtcs;
+    putU32(out + 4, s.version);
+    putU16(out + 8, clampU16(s.engine_rpm));
+    putU16(out + 10, (uint16_t)(int16_t)s.engine_temp);
+    putU16(out + 12, clampU16(s.vehicle_speed));
+    putU16(out + 14, clampU16(s.fuel_pressure));
+    putU16(out + 16, clampU16(s.distance_with_mil));
+    putU16(out + 18, clampU16(s.error_free_cycles));
+    putF32(out + 20, s.maf_rate);
+    putF32(out + 24, s.timing_advance);
+    putF32(out + 28, s.fuel_rate);
+    putF32(out + 32, s.fuel_level);
+    putF32(out + 36, s.battery_voltage);
+    putString(out + 40, s.vin, 17);
+    putString(out + 57, s.cal_id, 16);
+    putString(out + 73, s.cvn, 8);
+    out[81] = 0;
+    putDtcs(out + 82, s.dtcs, s.num_dtcs);
+    putDtcs(out + 92, s.permanent_dtcs, s.num_permanent_dtcs);
+}
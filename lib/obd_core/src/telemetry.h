@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vehicle_state.h"
+
+// ############## Бінарна телеметрія для WebSocket ##############
+// Компактна альтернатива JSON зі стану для веб-клієнтів, які попросили її
+// текстовим повідомленням "bin" після підключення ("json" - повернутися до тексту).
+// Розкладка фіксована, little-endian; декодер - DataView у web/app.js.
+// Будь-яка зміна розкладки -> новий TELEMETRY_SCHEMA.
+//
+//  зсув  тип       поле
+//    0   u8        схема (TELEMETRY_SCHEMA)
+//    1   u8        прапорці: біт 0 dynamic_rpm, 1 misfire_sim, 2 lean_mixture_sim
+//    2   u8        кількість DTC
+//    3   u8        кількість постійних DTC
+//    4   u32       версія стану
+//    8   u16       RPM
+//   10   i16       температура ОР, °C
+//   12   u16       швидкість, км/год
+//   14   u16       тиск палива, кПа
+//   16   u16       пробіг з MIL, км
+//   18   u16       цикли без помилок
+//   20   f32 x 5   MAF, кут випередження, витрата палива, рівень палива, напруга
+//   40   char[17]  VIN (доповнено нулями)
+//   57   char[16]  CAL ID
+//   73   char[8]   CVN
+//   81   u8        резерв
+//   82   u16 x 5   DTC (2 байти J1979: A << 8 | B)
+//   92   u16 x 5   постійні DTC
+const uint8_t TELEMETRY_SCHEMA = 1;
+const size_t TELEMETRY_FRAME_SIZE = 102;
+
+enum TelemetryFlags : uint8_t {
+    TELEMETRY_DYNAMIC_RPM = 1 << 0,
+    TELEMETRY_MISFIRE_SIM = 1 << 1,
+    TELEMETRY_LEAN_MIXTURE_SIM = 1 << 2,
+};
+
+// Записує рівно TELEMETRY_FRAME_SIZE байтів.
+void encodeTelemetry(const VehicleState &s, uint8_t *out);
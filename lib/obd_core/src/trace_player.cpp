@@ -0,0 +1,233 @@
+#include "trace_player.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+enum TraceField {
+    FIELD_RPM, FIELD_SPEED, FIELD_MAF, FIELD_TIMING, FIELD_TEMP, FIELD_FUEL_RATE,
+    FIELD_FUEL_PRESSURE, FIELD_FUEL, FIELD_VOLTAGE, FIELD_DIST_MIL,
+    NUM_FIELDS
+};
+
+// Назви - як параметри /update (applyStateUpdate)
+const char *const FIELD_NAMES[NUM_FIELDS] = {
+    "rpm", "speed", "maf", "timing", "temp", "fuel_rate", "fuel_pressure", "fuel", "voltage", "dist_mil",
+};
+
+const char DTC_COLUMN[] = "dtc";
+const char DTC_CLEAR[] = "clear";
+
+void setField(VehicleState &s, int field, float value) {
+    const int rounded = (int)lroundf(value);
+    switch (field) {
+        case FIELD_RPM: s.engine_rpm = rounded; break;
+        case FIELD_SPEED:
+            s.vehicle_speed = rounded;
+            s.transmission_gear = gearForSpeed(rounded);
+            break;
+        case FIELD_MAF: s.maf_rate = value; break;
+        case FIELD_TIMING: s.timing_advance = value; break;
+        case FIELD_TEMP: s.engine_temp = rounded; break;
+        case FIELD_FUEL_RATE: s.fuel_rate = value; break;
+        case FIELD_FUEL_PRESSURE: s.fuel_pressure = rounded; break;
+        case FIELD_FUEL: s.fuel_level = value; break;
+        case FIELD_VOLTAGE: s.battery_voltage = value; break;
+        case FIELD_DIST_MIL: s.distance_with_mil = rounded; break;
+    }
+}
+
+// Розбиває рядок на місці; повертає кількість клітинок (не більше max).
+int splitCsv(char *line, char **cells, int max) {
+    int n = 0;
+    char *p = line;
+    while (n < max) {
+        cells[n++] = p;
+        char *comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+    return n;
+}
+
+char *trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) *--end = '\0';
+    return s;
+}
+
+bool isSkippable(const char *line) {
+    while (*line == ' ' || *line == '\t' || *line == '\r') line++;
+    return *line == '\0' || *line == '#';
+}
+
+} // namespace
+
+bool TracePlayer::begin(TraceReader &reader, uint64_t now_us, float speed, bool loop) {
+    reader_ = &reader;
+    speed_ = speed > 0 ? speed : 1.0f;
+    loop_ = loop;
+    baseMs_ = 0;
+    loops_ = 0;
+    skipped_ = 0;
+    numEvents_ = 0;
+    error_ = "";
+
+    if (!reader.rewind() || !readHeader()) {
+        reader_ = nullptr;
+        return false;
+    }
+    if (!readRow(prev_, nullptr)) {
+        error_ = "trace has no data rows";
+        reader_ = nullptr;
+        return false;
+    }
+    firstMs_ = (uint32_t)prev_.at_ms;
+    originMs_ = prev_.at_ms;
+    positionMs_ = originMs_;
+    startUs_ = now_us;
+    queueEvent(prev_);
+    readNext();
+    return true;
+}
+
+bool TracePlayer::readHeader() {
+    char line[MAX_LINE];
+    do {
+        if (!reader_->readLine(line, sizeof(line))) {
+            error_ = "trace is empty";
+            return false;
+        }
+    } while (isSkippable(line));
+
+    char *cells[MAX_COLUMNS];
+    columns_ = splitCsv(line, cells, MAX_COLUMNS);
+    if (strcmp(trim(cells[0]), "t_ms") != 0) {
+        error_ = "first column must be t_ms";
+        return false;
+    }
+    dtcColumn_ = -1;
+    for (int c = 1; c < columns_; c++) {
+        const char *name = trim(cells[c]);
+        fields_[c] = -1;
+        if (strcmp(name, DTC_COLUMN) == 0) {
+            dtcColumn_ = c;
+            continue;
+        }
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (strcmp(name, FIELD_NAMES[f]) == 0) fields_[c] = f;
+        }
+        // Невідомі стовпчики ігноруються: траса може містити більше, ніж емулює ECU
+    }
+    return true;
+}
+
+bool TracePlayer::readRow(Row &row, const Row *previous) {
+    char line[MAX_LINE];
+    for (;;) {
+        if (!reader_->readLine(line, sizeof(line))) return false;
+        if (isSkippable(line)) continue;
+
+        char *cells[MAX_COLUMNS];
+        const int n = splitCsv(line, cells, MAX_COLUMNS);
+        char *end;
+        const char *t = trim(cells[0]);
+        const unsigned long t_ms = strtoul(t, &end, 10);
+        const uint64_t at_ms = baseMs_ + t_ms;
+        if (end == t || *end != '\0' || (previous && at_ms < previous->at_ms)) {
+            skipped_++; // Зіпсований або непослідовний рядок
+            continue;
+        }
+
+        row.at_ms = at_ms;
+        row.has = previous ? previous->has : 0;
+        if (previous) memcpy(row.values, previous->values, sizeof(row.values));
+        row.dtc[0] = '\0';
+        for (int c = 1; c < n && c < columns_; c++) {
+            const char *cell = trim(cells[c]);
+            if (*cell == '\0') continue;
+            if (c == dtcColumn_) {
+                strncpy(row.dtc, cell, sizeof(row.dtc) - 1);
+                row.dtc[sizeof(row.dtc) - 1] = '\0';
+            } else if (fields_[c] >= 0) {
+                row.values[c] = strtof(cell, nullptr);
+                row.has |= 1u << c;
+            }
+        }
+        return true;
+    }
+}
+
+// Наступний рядок після prev_; в кінці файлу з loop - перший рядок наступного проходу.
+void TracePlayer::readNext() {
+    hasNext_ = readRow(next_, &prev_);
+    if (hasNext_ || !loop_) return;
+
+    // Прохід нульової тривалості повторювати нема сенсу - інакше advance() не вийде з циклу
+    if (prev_.at_ms == baseMs_ + firstMs_) {
+        loop_ = false;
+        return;
+    }
+    // Перший рядок нового проходу збігається в часі з останнім рядком попереднього
+    baseMs_ = prev_.at_ms - firstMs_;
+    if (reader_->rewind() && readHeader() && readRow(next_, nullptr)) {
+        hasNext_ = true;
+        loops_++;
+    }
+}
+
+bool TracePlayer::advance(uint64_t now_us) {
+    if (!reader_) return false;
+    positionMs_ = originMs_ + (uint64_t)((double)(now_us - startUs_) * speed_ / 1000.0);
+    while (hasNext_ && next_.at_ms <= positionMs_) {
+        prev_ = next_;
+        queueEvent(prev_);
+        readNext();
+    }
+    return hasNext_;
+}
+
+void TracePlayer::queueEvent(const Row &row) {
+    if (row.dtc[0] == '\0') return;
+    if (strncmp(row.dtc, DTC_CLEAR, 5) == 0) {
+        numEvents_ = 0; // Коди до скидання вже не мають значення
+    } else if (numEvents_ >= MAX_DTCS + 1) {
+        return;
+    }
+    strcpy(events_[numEvents_++], row.dtc);
+}
+
+int TracePlayer::apply(VehicleState &s) {
+    float frac = 0;
+    if (hasNext_ && next_.at_ms > prev_.at_ms && positionMs_ > prev_.at_ms) {
+        frac = (float)(positionMs_ - prev_.at_ms) / (float)(next_.at_ms - prev_.at_ms);
+        if (frac > 1) frac = 1;
+    }
+    for (int c = 1; c < columns_; c++) {
+        if (fields_[c] < 0 || !(prev_.has & (1u << c))) continue;
+        float value = prev_.values[c];
+        if (hasNext_ && (next_.has & (1u << c))) value += (next_.values[c] - value) * frac;
+        setField(s, fields_[c], value);
+    }
+
+    // Події - після значень рядка, щоб freeze frame зберіг саме їх
+    int added = 0;
+    for (int i = 0; i < numEvents_; i++) {
+        if (strncmp(events_[i], DTC_CLEAR, 5) == 0) {
+            clearCurrentDtcs(s);
+            added = 0; // Коди до скидання вже не в списку
+        } else {
+            // Лише коди, дописані в кінець поточних: їх (останні added) журналює викликач.
+            // Код, що потрапив тільки в постійні, не рахується.
+            const int before = s.num_dtcs;
+            addDTC(s, events_[i]);
+            if (s.num_dtcs > before) added++;
+        }
+    }
+    numEvents_ = 0;
+    return added;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vehicle_state.h"
+
+// ############## Відтворення записаних поїздок ##############
+// Трасу - CSV з часовими мітками - читають рядок за рядком: у пам'яті лише два
+// сусідні рядки, тож довжина траси не обмежена RAM. Між рядками числові значення
+// інтерполюються лінійно; позиція рахується від мікросекундного годинника,
+// тож результат не залежить від того, як часто викликається advance().
+//
+//   # коментар
+//   t_ms,rpm,speed,maf,temp,dtc
+//   0,800,0,2.5,85,
+//   1500,2400,35,18.0,86,P0300
+//   3000,,60,,,clear
+//
+// Перший стовпчик - t_ms (неспадний), решта - у будь-якому порядку й наборі:
+// rpm, speed, maf, timing, temp, fuel_rate, fuel_pressure, fuel, voltage, dist_mil
+// та dtc - подія в момент рядка: код додається (addDTC), "clear" - скидання поточних.
+// Порожня клітинка - значення не змінюється (попереднє тримається до наступного).
+
+class TraceReader {
+public:
+    virtual ~TraceReader() {}
+    // Рядок без '\n' (і без '\r'); false - кінець файлу.
+    virtual bool readLine(char *buf, size_t size) = 0;
+    virtual bool rewind() = 0;
+};
+
+class TracePlayer {
+public:
+    static const int MAX_COLUMNS = 12;
+    static const size_t MAX_LINE = 160;
+
+    // Читає заголовок і перші рядки; false - формат не підтримується (див. error()).
+    // speed - множник швидкості відтворення, loop - починати спочатку після кінця.
+    bool begin(TraceReader &reader, uint64_t now_us, float speed = 1.0f, bool loop = true);
+    void stop() { reader_ = nullptr; }
+    bool active() const { return reader_ != nullptr; }
+    const char *error() const { return error_; }
+
+    // Просуває позицію до now_us, дочитуючи файл. false - траса закінчилась (без loop).
+    bool advance(uint64_t now_us);
+    // Записує інтерпольовані значення та події DTC, що настали з попереднього виклику.
+    // Повертає кількість кодів, дописаних у кінець s.dtcs (нові - останні в списку).
+    int apply(VehicleState &s);
+
+    // Позиція в поточному проході траси (t_ms файлу)
+    uint32_t positionMs() const { return (uint32_t)(positionMs_ - baseMs_); }
+    uint32_t loops() const { return loops_; }
+    uint32_t skippedLines() const { return skipped_; }
+
+private:
+    struct Row {
+        uint64_t at_ms;  // Час відтворення: baseMs_ + t_ms файлу
+        float values[MAX_COLUMNS];
+        uint16_t has;    // Біт на стовпчик: значення задано (або успадковано)
+        char dtc[6];     // Подія рядка: код, "clear" - скидання (усічено до 5), "" - немає
+    };
+
+    bool readHeader();
+    bool readRow(Row &row, const Row *previous); // false - кінець файлу
+    void readNext();
+    void queueEvent(const Row &row);
+
+    TraceReader *reader_ = nullptr;
+    const char *error_ = "";
+    int columns_ = 0;
+    int8_t fields_[MAX_COLUMNS] = {};
+    int dtcColumn_ = -1;
+    float speed_ = 1.0f;
+    bool loop_ = true;
+
+    uint64_t startUs_ = 0;
+    uint64_t originMs_ = 0;   // Час першого рядка
+    uint64_t positionMs_ = 0; // originMs_ + час від begin() x speed
+    uint64_t baseMs_ = 0;     // Зсув t_ms поточного проходу (росте з кожним повтором)
+    uint32_t firstMs_ = 0;    // t_ms першого рядка файлу
+    uint32_t loops_ = 0;
+    uint32_t skipped_ = 0;
+    Row prev_ = {};
+    Row next_ = {};
+    bool hasNext_ = false;
+
+    // Події між викликами apply(): щонайбільше MAX_DTCS кодів + скидання
+    char events_[MAX_DTCS + 1][6] = {};
+    int numEvents_ = 0;
+};
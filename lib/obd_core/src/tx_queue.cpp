@@ -0,0 +1,73 @@
+#include "tx_queue.h"
+
+namespace {
+
+// Порівняння з урахуванням переповнення micros()
+bool isExpired(uint32_t deadline_us, uint32_t now_us) {
+    return (int32_t)(now_us - deadline_us) > 0;
+}
+
+} // namespace
+
+bool TxQueue::push(const CanFrame &frame, uint8_t priority, uint32_t deadline_us) {
+    if (count_ == CAPACITY) {
+        // Жертва - найновіший кадр з найнижчим пріоритетом
+        size_t victim = 0;
+        for (size_t i = 1; i < count_; i++) {
+            const Entry &e = entries_[i];
+            const Entry &v = entries_[victim];
+            if (e.priority > v.priority || (e.priority == v.priority && (int32_t)(e.seq - v.seq) > 0)) {
+                victim = i;
+            }
+        }
+        if (entries_[victim].priority <= priority) {
+            stats_.dropped_full++;
+            return false;
+        }
+        removeAt(victim);
+        stats_.evicted++;
+    }
+
+    Entry &e = entries_[count_++];
+    e.frame = frame;
+    e.deadline_us = deadline_us;
+    e.seq = nextSeq_++;
+    e.priority = priority;
+    stats_.queued++;
+    return true;
+}
+
+bool TxQueue::front(uint32_t now_us, CanFrame &frame) {
+    for (size_t i = 0; i < count_;) {
+        if (isExpired(entries_[i].deadline_us, now_us)) {
+            removeAt(i);
+            stats_.expired++;
+        } else {
+            i++;
+        }
+    }
+    if (count_ == 0) return false;
+    frame = entries_[best()].frame;
+    return true;
+}
+
+void TxQueue::popFront() {
+    if (count_ > 0) removeAt(best());
+}
+
+size_t TxQueue::best() const {
+    size_t best = 0;
+    for (size_t i = 1; i < count_; i++) {
+        const Entry &e = entries_[i];
+        const Entry &b = entries_[best];
+        if (e.priority < b.priority || (e.priority == b.priority && (int32_t)(e.seq - b.seq) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void TxQueue::removeAt(size_t index) {
+    // Порядок у масиві не важливий - його задає seq
+    entries_[index] = entries_[--count_];
+}
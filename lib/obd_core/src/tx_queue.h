@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_frame.h"
+
+// ############## Програмна черга передачі ##############
+// Кадри, які не вмістилися в TX-чергу драйвера CAN (або шина в bus-off), чекають тут,
+// поки CAN-задача не передасть їх драйверу. Кожен кадр має:
+//  - пріоритет (0 - найвищий): першим іде кадр з найвищим пріоритетом, за рівного - старіший,
+//    тож кадри одного ECU (один пріоритет) ніколи не переставляються;
+//  - дедлайн: прострочений кадр відкидається - тестер уже не чекає цієї відповіді.
+// Якщо черга заповнена, новий кадр витісняє найновіший кадр з нижчим пріоритетом,
+// інакше відкидається сам. Клас не є потокобезпечним - власник тримає м'ютекс.
+class TxQueue {
+public:
+    static const size_t CAPACITY = 32;
+
+    struct Stats {
+        uint32_t queued;         // Прийнято в чергу
+        uint32_t dropped_full;   // Відкинуто: черга заповнена
+        uint32_t evicted;        // Витіснено кадром з вищим пріоритетом
+        uint32_t expired;        // Відкинуто після дедлайну
+    };
+
+    bool push(const CanFrame &frame, uint8_t priority, uint32_t deadline_us);
+
+    // Відкидає прострочені кадри і копіює наступний до передачі. false - черга порожня.
+    bool front(uint32_t now_us, CanFrame &frame);
+    void popFront();
+
+    void clear() { count_ = 0; }
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    const Stats &stats() const { return stats_; }
+
+private:
+    struct Entry {
+        CanFrame frame;
+        uint32_t deadline_us;
+        uint32_t seq;      // Порядок надходження (FIFO за рівного пріоритету)
+        uint8_t priority;
+    };
+
+    void removeAt(size_t index);
+    size_t best() const;
+
+    Entry entries_[CAPACITY];
+    size_t count_ = 0;
+    uint32_t nextSeq_ = 0;
+    Stats stats_ = {};
+};
@@ -0,0 +1,242 @@
+#include "vehicle_sim.h"
+
+namespace {
+
+const float DT = VehicleSim::STEP_MS / 1000.0f;
+
+// ---- Цикл їзди: педаль (>0) або гальмо (<0), %, лінійно між точками, повтор ----
+struct CyclePoint {
+    uint32_t t_ms;
+    int8_t pedal;
+};
+const CyclePoint DRIVE_CYCLE[] = {
+    {0, 0},         // Холостий хід
+    {4000, 0},
+    {4500, 60},     // Розгін
+    {12000, 60},
+    {13000, 30},    // Круїз
+    {25000, 30},
+    {26000, 85},    // Обгін
+    {31000, 85},
+    {32000, 0},     // Накат (гальмування двигуном)
+    {38000, 0},
+    {39000, -30},   // Гальмування до зупинки
+    {47000, -30},
+    {48000, 0},
+    {50000, 0},
+};
+const int NUM_CYCLE_POINTS = sizeof(DRIVE_CYCLE) / sizeof(DRIVE_CYCLE[0]);
+const uint32_t CYCLE_MS = DRIVE_CYCLE[NUM_CYCLE_POINTS - 1].t_ms;
+
+// ---- Двигун: 1.6 л, атмосферний ----
+const float IDLE_RPM = 800;
+const float REDLINE_RPM = 6500;
+const float LAUNCH_RPM = 1800;    // Прослизання гідротрансформатора на повній педалі
+const float RPM_RESPONSE = 0.15f; // Частка різниці до цільових обертів за крок
+const float DISPLACEMENT_L = 1.6f;
+const float AIR_DENSITY = 1.2f;   // г/л
+const float IDLE_LOAD = 0.2f;
+const float AFR = 14.7f;
+const float FUEL_DENSITY = 745;   // г/л
+// Крутний момент, Н·м, кожні 1000 об/хв від 0
+const float TORQUE_CURVE[] = {60, 110, 135, 150, 155, 150, 140, 110};
+const int TORQUE_POINTS = sizeof(TORQUE_CURVE) / sizeof(TORQUE_CURVE[0]);
+
+// ---- Трансмісія: ті самі передаточні числа, що в PID 0xA4 ----
+const float GEAR_RATIOS[] = {0, 3.538f, 2.060f, 1.404f, 1.000f, 0.713f, 0.582f};
+const int TOP_GEAR = 6;
+const float FINAL_DRIVE = 4.1f;
+const float WHEEL_RADIUS_M = 0.31f;
+const float DRIVELINE_EFFICIENCY = 0.9f;
+// Оберти двигуна на 1 км/год: (1000/60) / (2*pi*r) * головна пара * передача
+const float RPM_PER_KMH = 16.6667f / (6.28318f * WHEEL_RADIUS_M) * FINAL_DRIVE;
+const float UPSHIFT_RPM = 2000;   // + UPSHIFT_PEDAL_RPM * педаль
+const float UPSHIFT_PEDAL_RPM = 2500;
+const float DOWNSHIFT_RPM = 1300;
+const float KICKDOWN_PEDAL = 0.8f;
+const float KICKDOWN_MARGIN_RPM = 500; // Нижча передача не має одразу впертися в поріг перемикання вгору
+
+// ---- Кузов ----
+const float MASS_KG = 1300;
+const float ROLLING_N = 150;      // 0.012 * m * g
+const float AERO_N_PER_MS2 = 0.4f; // 0.5 * ro * Cd * A
+const float BRAKE_N = 10000;      // Повне гальмо ~0.8 g
+
+// ---- Охолодження ----
+const float AMBIENT_C = 20;
+const float HEAT_CAPACITY_J_PER_K = 15000;
+const float FUEL_HEAT_J_PER_G = 44000;
+const float HEAT_TO_COOLANT = 0.3f;
+const float BASE_LOSS_W_PER_K = 10;
+const float THERMOSTAT_C = 88;     // Починає відкриватись
+const float RADIATOR_W_PER_K2 = 150; // Ступінь відкриття росте на градус вище THERMOSTAT_C
+const float RADIATOR_MAX_W_PER_K = 1500;
+
+const float TANK_L = 50;
+
+float interpolate(const float *table, int points, float step, float x) {
+    if (x <= 0) return table[0];
+    const float pos = x / step;
+    const int i = (int)pos;
+    if (i >= points - 1) return table[points - 1];
+    return table[i] + (table[i + 1] - table[i]) * (pos - i);
+}
+
+float clampf(float value, float lo, float hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+int roundToInt(float value) {
+    return (int)(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+} // namespace
+
+void VehicleSim::reset(const VehicleState &s) {
+    cycleMs_ = 0;
+    cycleIndex_ = 0;
+    pedal_ = 0;
+    brake_ = 0;
+    distanceM_ = 0;
+    rpm_ = s.engine_rpm;
+    speedKmh_ = s.vehicle_speed;
+    coolantC_ = s.engine_temp;
+    fuelL_ = s.fuel_level * TANK_L / 100;
+    gear_ = s.transmission_gear < 0 ? 0 : (s.transmission_gear > TOP_GEAR ? TOP_GEAR : s.transmission_gear);
+    publishedSpeed_ = s.vehicle_speed;
+    publishedTemp_ = s.engine_temp;
+    publishedFuel_ = s.fuel_level;
+}
+
+void VehicleSim::syncExternalChanges(const VehicleState &s) {
+    if (s.vehicle_speed != publishedSpeed_) {
+        speedKmh_ = s.vehicle_speed;
+        gear_ = gearForSpeed(s.vehicle_speed);
+    }
+    if (s.engine_temp != publishedTemp_) coolantC_ = s.engine_temp;
+    if (s.fuel_level != publishedFuel_) fuelL_ = s.fuel_level * TANK_L / 100;
+}
+
+// Автоматична коробка: раніше перемикається вгору на малій педалі, на майже
+// повній - kickdown на нижчу передачу
+void VehicleSim::updateGear() {
+    if (gear_ == 0) {
+        if (pedal_ > 0) gear_ = 1;
+        return;
+    }
+    if (speedKmh_ < 2 && pedal_ == 0) {
+        gear_ = 0;
+        return;
+    }
+    const float upshift_rpm = UPSHIFT_RPM + UPSHIFT_PEDAL_RPM * pedal_;
+    const float gear_rpm = speedKmh_ * RPM_PER_KMH * GEAR_RATIOS[gear_];
+    if (gear_ < TOP_GEAR && gear_rpm > upshift_rpm) {
+        gear_++;
+    } else if (gear_ > 1 && gear_rpm < DOWNSHIFT_RPM) {
+        gear_--;
+    } else if (gear_ > 1 && pedal_ >= KICKDOWN_PEDAL &&
+               speedKmh_ * RPM_PER_KMH * GEAR_RATIOS[gear_ - 1] < upshift_rpm - KICKDOWN_MARGIN_RPM) {
+        gear_--; // Kickdown
+    }
+}
+
+const char *VehicleSim::step(VehicleState &s) {
+    syncExternalChanges(s);
+
+    // Педаль і гальмо за циклом їзди
+    cycleMs_ += STEP_MS;
+    if (cycleMs_ >= CYCLE_MS) {
+        cycleMs_ -= CYCLE_MS;
+        cycleIndex_ = 0;
+    }
+    while (cycleIndex_ < NUM_CYCLE_POINTS - 2 && DRIVE_CYCLE[cycleIndex_ + 1].t_ms <= cycleMs_) cycleIndex_++;
+    const CyclePoint &a = DRIVE_CYCLE[cycleIndex_];
+    const CyclePoint &b = DRIVE_CYCLE[cycleIndex_ + 1];
+    const float command = (a.pedal + (b.pedal - a.pedal) * (float)(cycleMs_ - a.t_ms) / (float)(b.t_ms - a.t_ms)) / 100;
+    pedal_ = command > 0 ? command : 0;
+    brake_ = command < 0 ? -command : 0;
+
+    updateGear();
+
+    // Оберти: жорстко пов'язані зі швидкістю на передачі, не нижче холостих/прослизання
+    float target_rpm = IDLE_RPM + LAUNCH_RPM * pedal_;
+    if (gear_ > 0) {
+        const float coupled = speedKmh_ * RPM_PER_KMH * GEAR_RATIOS[gear_];
+        if (coupled > target_rpm) target_rpm = coupled;
+    }
+    rpm_ = clampf(rpm_ + (target_rpm - rpm_) * RPM_RESPONSE, 0, REDLINE_RPM);
+
+    // Рух: тяга (або гальмування двигуном) проти опору кочення, повітря та гальм
+    const float friction_nm = 15 + rpm_ / 200;
+    const float torque_nm = interpolate(TORQUE_CURVE, TORQUE_POINTS, 1000, rpm_) * pedal_ - friction_nm;
+    const float wheel_n = gear_ > 0 ? torque_nm * GEAR_RATIOS[gear_] * FINAL_DRIVE * DRIVELINE_EFFICIENCY / WHEEL_RADIUS_M : 0;
+    const float v = speedKmh_ / 3.6f;
+    const float resist_n = v > 0 ? ROLLING_N + AERO_N_PER_MS2 * v * v + BRAKE_N * brake_ : 0;
+    speedKmh_ += (wheel_n - resist_n) / MASS_KG * DT * 3.6f;
+    if (speedKmh_ < 0) speedKmh_ = 0;
+
+    // Повітря й пальне від навантаження
+    load_ = IDLE_LOAD + (1 - IDLE_LOAD) * pedal_;
+    const float maf_gs = DISPLACEMENT_L * rpm_ / 120 * load_ * AIR_DENSITY;
+    const float fuel_gs = maf_gs / AFR;
+
+    // Охолоджувальна рідина: частина теплоти згоряння, термостат відкривається з THERMOSTAT_C
+    float loss_w_per_k = BASE_LOSS_W_PER_K;
+    if (coolantC_ > THERMOSTAT_C) {
+        const float radiator = clampf((coolantC_ - THERMOSTAT_C) * RADIATOR_W_PER_K2, 0, RADIATOR_MAX_W_PER_K);
+        loss_w_per_k += radiator * (1 + speedKmh_ / 50); // Набігаючий потік
+    }
+    const float heat_w = fuel_gs * FUEL_HEAT_J_PER_G * HEAT_TO_COOLANT - (coolantC_ - AMBIENT_C) * loss_w_per_k;
+    coolantC_ += heat_w / HEAT_CAPACITY_J_PER_K * DT;
+
+    fuelL_ -= fuel_gs / FUEL_DENSITY * DT;
+    if (fuelL_ < 0) fuelL_ = 0;
+
+    s.engine_rpm = roundToInt(rpm_);
+    s.vehicle_speed = roundToInt(speedKmh_);
+    s.transmission_gear = gear_;
+    s.engine_temp = roundToInt(coolantC_);
+    s.maf_rate = maf_gs;
+    s.fuel_rate = fuel_gs * 3600 / FUEL_DENSITY;
+    s.fuel_pressure = 350 + roundToInt(load_ * 50);
+    s.timing_advance = 10 + rpm_ * 0.004f - load_ * 12;
+    s.fuel_level = fuelL_ * 100 / TANK_L;
+
+    // Пробіг з MIL - цілими кілометрами
+    distanceM_ += v * DT;
+    if (distanceM_ >= 1000) {
+        distanceM_ -= 1000;
+        if (s.num_dtcs > 0) s.distance_with_mil++;
+    }
+
+    const char *new_dtc = simulateFaults(s);
+    publishedSpeed_ = s.vehicle_speed;
+    publishedTemp_ = s.engine_temp;
+    publishedFuel_ = s.fuel_level;
+    return new_dtc;
+}
+
+const char *VehicleSim::simulateFaults(VehicleState &s) {
+    const char *new_dtc = nullptr;
+    if (s.misfire_simulation_enabled && s.engine_rpm > 3500) {
+        if (addDTC(s, "P0300")) new_dtc = "P0300";
+    }
+
+    // Емуляція бідної суміші (P0171) при низькому тиску пального
+    if (s.lean_mixture_simulation_enabled) {
+        s.fuel_pressure = 150 + random() % 30; // Імітуємо падіння тиску до ~165 kPa
+        // Якщо тиск низький (< 200 kPa) і є навантаження (RPM > 2000)
+        if (s.fuel_pressure < 200 && s.engine_rpm > 2000) {
+            if (addDTC(s, "P0171")) new_dtc = "P0171";
+        }
+    }
+    return new_dtc;
+}
+
+// xorshift32: детермінований і без стану libc
+uint32_t VehicleSim::random() {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return rng_;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "vehicle_state.h"
+
+// ############## Модель руху автомобіля ##############
+// Режим dynamic_rpm: замість синусоїди - зв'язана модель з фіксованим кроком
+// STEP_MS (100 Гц): педаль за циклом їзди -> оберти -> автоматична коробка ->
+// швидкість, витрата повітря й пального від навантаження, нагрів охолоджувальної
+// рідини з термостатом, рівень пального та пробіг. Крок - кілька множень
+// з плаваючою комою і таблиці з лінійною інтерполяцією, без libm, тож вартість
+// кроку стала й не залежить від того, як часто його викликають.
+//
+// Модель тримає власний точний стан (швидкість, оберти, температура - float),
+// у VehicleState записує округлені значення. Якщо поле змінили ззовні (/update),
+// модель підхоплює нове значення на наступному кроці.
+
+class VehicleSim {
+public:
+    static const uint32_t STEP_MS = 10;
+
+    // Починає цикл їзди з поточного стану автомобіля.
+    void reset(const VehicleState &s);
+
+    // Один крок STEP_MS. Повертає код DTC, щойно доданий симуляцією несправностей
+    // (misfire, lean), або nullptr.
+    const char *step(VehicleState &s);
+
+    float throttle() const { return pedal_; }
+    float load() const { return load_; }
+
+private:
+    void syncExternalChanges(const VehicleState &s);
+    void updateGear();
+    const char *simulateFaults(VehicleState &s);
+    uint32_t random();
+
+    uint32_t cycleMs_ = 0;      // Позиція в циклі їзди
+    uint8_t cycleIndex_ = 0;    // Поточний відрізок таблиці циклу
+    float pedal_ = 0;           // 0..1
+    float brake_ = 0;           // 0..1
+    float load_ = 0;            // 0..1
+    float rpm_ = 0;
+    float speedKmh_ = 0;
+    float coolantC_ = 0;
+    float fuelL_ = 0;
+    float distanceM_ = 0;       // Залишок до наступного повного км
+    int gear_ = 0;
+    uint32_t rng_ = 0x12345678;
+
+    // Останні записані значення: розбіжність - зміна ззовні
+    int publishedSpeed_ = -1;
+    int publishedTemp_ = -1000;
+    float publishedFuel_ = -1;
+};
@@ -0,0 +1,205 @@
+#include "vehicle_state.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool appendDtc(char (*list)[6], int &count, const char *code) {
+    if (count >= MAX_DTCS) return false;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(list[i], code) == 0) return false;
+    }
+    strncpy(list[count], code, 5);
+    list[count][5] = '\0';
+    count++;
+    return true;
+}
+
+static int16_t clampInt16(int value) {
+    return value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+}
+
+static void captureFreezeFrame(VehicleState &s, const char *code) {
+    if (s.num_freeze_frames >= MAX_FREEZE_FRAMES) return;
+    FreezeFrame &f = s.freeze_frames[s.num_freeze_frames++];
+    memcpy(f.dtc, code, sizeof(f.dtc));
+    f.vehicle_speed = s.vehicle_speed < 0 ? 0 : (s.vehicle_speed > 255 ? 255 : s.vehicle_speed);
+    f.transmission_gear = s.transmission_gear < 0 ? 0 : s.transmission_gear;
+    f.engine_rpm = clampInt16(s.engine_rpm);
+    f.engine_temp = clampInt16(s.engine_temp);
+    f.fuel_pressure = clampInt16(s.fuel_pressure);
+    f.distance_with_mil = s.distance_with_mil < 0 ? 0 : (s.distance_with_mil > 0xFFFF ? 0xFFFF : s.distance_with_mil);
+    f.maf_rate = s.maf_rate;
+    f.timing_advance = s.timing_advance;
+    f.fuel_rate = s.fuel_rate;
+    f.fuel_level = s.fuel_level;
+}
+
+bool addDTC(VehicleState &s, const char *new_dtc) {
+    bool added_to_current = appendDtc(s.dtcs, s.num_dtcs, new_dtc);
+    bool added_to_permanent = appendDtc(s.permanent_dtcs, s.num_permanent_dtcs, new_dtc);
+    if (added_to_current) captureFreezeFrame(s, s.dtcs[s.num_dtcs - 1]);
+    return added_to_current || added_to_permanent;
+}
+
+void clearCurrentDtcs(VehicleState &s) {
+    // Скидаємо коди помилок
+    s.num_dtcs = 0;
+    for (int i = 0; i < MAX_DTCS; i++) {
+        s.dtcs[i][0] = '\0';
+    }
+    s.num_freeze_frames = 0;
+
+    // Скидаємо лічильник пробігу з помилкою
+    s.distance_with_mil = 0;
+}
+
+void restoreFreezeFrame(const FreezeFrame &frame, VehicleState &out) {
+    out.vehicle_speed = frame.vehicle_speed;
+    out.transmission_gear = frame.transmission_gear;
+    out.engine_rpm = frame.engine_rpm;
+    out.engine_temp = frame.engine_temp;
+    out.fuel_pressure = frame.fuel_pressure;
+    out.distance_with_mil = frame.distance_with_mil;
+    out.maf_rate = frame.maf_rate;
+    out.timing_advance = frame.timing_advance;
+    out.fuel_rate = frame.fuel_rate;
+    out.fuel_level = frame.fuel_level;
+    memcpy(out.dtcs[0], frame.dtc, sizeof(frame.dtc));
+    out.num_dtcs = 1;
+}
+
+static void countIptCycle(VehicleState &s) {
+    s.ipt[0]++; // OBDCOND
+    s.ipt[1]++; // IGNCNTR
+    for (int i = 2; i + 1 < IPT_COUNTERS; i += 2) {
+        if (s.ipt[i + 1] == 0) continue; // Монітор відсутній (напр. другий банк)
+        s.ipt[i + 1]++;
+        if (s.num_dtcs == 0) s.ipt[i]++;
+    }
+}
+
+bool applyDrivingCycle(VehicleState &s) {
+    countIptCycle(s);
+    if (s.num_dtcs > 0) {
+        // Є поточні DTC - лічильник циклів без помилок скидається
+        s.error_free_cycles = 0;
+        return false;
+    }
+    s.error_free_cycles++;
+    if (s.error_free_cycles < CYCLES_THRESHOLD || s.num_permanent_dtcs == 0) return false;
+
+    s.num_permanent_dtcs = 0;
+    for (int i = 0; i < MAX_DTCS; i++) s.permanent_dtcs[i][0] = '\0';
+    return true;
+}
+
+static bool isTrue(const char *value) {
+    return strcmp(value, "true") == 0 || strcmp(value, "1") == 0 || strcmp(value, "on") == 0;
+}
+
+static int clampInt(int value, int lo, int hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+int gearForSpeed(int speed_kmh) {
+    return speed_kmh <= 0 ? 0 : clampInt(speed_kmh / 25 + 1, 1, 6);
+}
+
+// Копіює код без пробілів по краях; true - якщо це повний DTC (5 символів).
+static bool parseDtcToken(const char *begin, const char *end, char *out) {
+    while (begin < end && isspace((unsigned char)*begin)) begin++;
+    while (end > begin && isspace((unsigned char)end[-1])) end--;
+    if (end - begin != 5) return false;
+    memcpy(out, begin, 5);
+    out[5] = '\0';
+    return true;
+}
+
+void applyStateUpdate(VehicleState &s, const StateParams &params) {
+    const char *value;
+    if ((value = params.get("vin"))) strncpy(s.vin, value, 17);
+    if ((value = params.get("cal_id"))) strncpy(s.cal_id, value, 16);
+    if ((value = params.get("cvn"))) strncpy(s.cvn, value, 8);
+
+    // Скидаємо старі DTC; їхні freeze frames переносяться нижче за кодом
+    FreezeFrame previous[MAX_FREEZE_FRAMES];
+    const int num_previous = s.num_freeze_frames;
+    memcpy(previous, s.freeze_frames, sizeof(previous));
+    s.num_dtcs = 0;
+    s.num_permanent_dtcs = 0;
+    s.num_freeze_frames = 0;
+    for (int i = 0; i < MAX_DTCS; i++) {
+        s.dtcs[i][0] = '\0';
+        s.permanent_dtcs[i][0] = '\0';
+    }
+
+    // Якщо прийшов параметр dtc_list (кома-розділений список), використаємо його (переважно)
+    if ((value = params.get("dtc_list"))) {
+        const char *start = value;
+        while (s.num_dtcs < MAX_DTCS) {
+            const char *comma = strchr(start, ',');
+            const char *end = comma ? comma : start + strlen(start);
+            // При оновленні з веб-форми, заповнюємо обидва списки однаково
+            if (parseDtcToken(start, end, s.dtcs[s.num_dtcs])) {
+                strcpy(s.permanent_dtcs[s.num_dtcs], s.dtcs[s.num_dtcs]);
+                s.num_dtcs++;
+            }
+            if (!comma) break;
+            start = comma + 1;
+        }
+    } else {
+        // Збираємо нові DTC з частин (зворотна сумісність зі старою формою)
+        for (int i = 1; i <= MAX_DTCS; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "dtc%d_code", i);
+            const char *code = params.get(name);
+            if (!code || code[0] == '\0') continue;
+            snprintf(name, sizeof(name), "dtc%d_sys", i);
+            const char *sys = params.get(name);
+            snprintf(name, sizeof(name), "dtc%d_type", i);
+            const char *type = params.get(name);
+
+            char dtc_full[16];
+            snprintf(dtc_full, sizeof(dtc_full), "%s%s%s", sys ? sys : "", type ? type : "", code);
+            if (strlen(dtc_full) >= 4) {
+                strncpy(s.dtcs[s.num_dtcs], dtc_full, 5);
+                s.dtcs[s.num_dtcs][5] = '\0';
+                s.num_dtcs++;
+            }
+        }
+    }
+    s.num_permanent_dtcs = s.num_dtcs; // Синхронізуємо лічильники
+
+    if ((value = params.get("temp"))) s.engine_temp = atoi(value);
+    if ((value = params.get("rpm"))) s.engine_rpm = atoi(value);
+    if ((value = params.get("speed"))) s.vehicle_speed = atoi(value);
+    s.transmission_gear = gearForSpeed(s.vehicle_speed);
+    if ((value = params.get("maf"))) s.maf_rate = atof(value);
+    if ((value = params.get("timing"))) s.timing_advance = atof(value);
+    if ((value = params.get("fuel_rate"))) s.fuel_rate = atof(value);
+    if ((value = params.get("fuel_pressure"))) s.fuel_pressure = atoi(value);
+
+    if ((value = params.get("fuel"))) s.fuel_level = atof(value);
+    if ((value = params.get("dist_mil"))) s.distance_with_mil = atoi(value);
+    if ((value = params.get("voltage"))) s.battery_voltage = atof(value);
+
+    if ((value = params.get("dynamic_rpm"))) s.dynamic_rpm_enabled = isTrue(value);
+    if ((value = params.get("misfire_sim"))) s.misfire_simulation_enabled = isTrue(value);
+    if ((value = params.get("lean_mixture_sim"))) s.lean_mixture_simulation_enabled = isTrue(value);
+
+    // Кадр N належить dtcs[N]: код, що лишився, зберігає свій кадр,
+    // новий з веб-форми отримує кадр з щойно застосованих значень
+    for (int i = 0; i < s.num_dtcs; i++) {
+        int found = -1;
+        for (int j = 0; j < num_previous && found < 0; j++) {
+            if (strcmp(previous[j].dtc, s.dtcs[i]) == 0) found = j;
+        }
+        if (found >= 0) {
+            s.freeze_frames[s.num_freeze_frames++] = previous[found];
+        } else {
+            captureFreezeFrame(s, s.dtcs[i]);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+// ############## Стан емульованого автомобіля ##############
+// Усі значення, які бачать CAN-відповіді, веб-інтерфейс та дисплей, зібрані
+// в одній структурі. Вона публікується через SeqLock (див. main.cpp:
+// updateVehicleState / vehicle.read()), тож CAN-шлях завжди читає узгоджений знімок.
+
+const int MAX_DTCS = 5;
+const int CYCLES_THRESHOLD = 3; // Кількість циклів для очищення Permanent DTC
+const int MAX_FREEZE_FRAMES = MAX_DTCS; // Один кадр на кожен поточний DTC
+// In-use performance tracking (сервіс 09, InfoType 0x08/0x0B): OBDCOND, IGNCNTR,
+// далі 7 пар "завершено / умови виконано" для моніторів.
+const int IPT_COUNTERS = 16;
+
+// Freeze frame (сервіс 02): умови в момент встановлення DTC. Лише поля, які
+// кодують PID-и сервісу 01, фіксованого розміру - захоплення є простим копіюванням.
+struct FreezeFrame {
+    char dtc[6];           // Код, що спричинив збереження кадру (PID 0x02)
+    uint8_t vehicle_speed;
+    uint8_t transmission_gear;
+    int16_t engine_rpm;
+    int16_t engine_temp;
+    int16_t fuel_pressure;
+    uint16_t distance_with_mil;
+    float maf_rate;
+    float timing_advance;
+    float fuel_rate;
+    float fuel_level;
+};
+
+struct VehicleState {
+    uint32_t version = 0; // Збільшується при кожній публікації
+
+    char vin[18] = "VIN_NOT_SET";
+    char cal_id[17] = "EMULATOR_CAL_ID";
+    char cvn[9] = "A1B2C3D4";
+
+    char dtcs[MAX_DTCS][6] = {};
+    int num_dtcs = 0;
+    char permanent_dtcs[MAX_DTCS][6] = {};
+    int num_permanent_dtcs = 0;
+    int error_free_cycles = 0;
+    uint16_t ipt[IPT_COUNTERS] = {42, 57, 38, 42, 0, 0, 40, 42, 0, 0, 35, 42, 0, 0, 31, 42};
+    FreezeFrame freeze_frames[MAX_FREEZE_FRAMES] = {}; // Номер кадру = індекс
+    int num_freeze_frames = 0;
+
+    int engine_rpm = 1500;
+    int engine_temp = 90;
+    int vehicle_speed = 60;      // km/h
+    float maf_rate = 10.0;       // g/s
+    float timing_advance = 5.0;  // degrees
+    float fuel_rate = 1.5;       // L/h
+    int fuel_pressure = 350;     // kPa (Normal ~300-400)
+    float fuel_level = 75.0;     // %
+    int distance_with_mil = 0;   // km
+    float battery_voltage = 14.2; // V
+    int transmission_gear = 3;   // Поточна передача (TCM, PID 0xA4)
+
+    bool dynamic_rpm_enabled = false; // Модель руху (vehicle_sim.h)
+    bool misfire_simulation_enabled = false;
+    bool lean_mixture_simulation_enabled = false;
+};
+
+// Додає DTC до поточних і постійних, якщо його там ще немає. true - якщо щось додано.
+// Новий поточний код зберігає freeze frame з поточних значень стану.
+bool addDTC(VehicleState &s, const char *new_dtc);
+
+// Сервіс 04 / кнопка "Clear DTC": скидає поточні коди, freeze frames та пробіг з MIL.
+// Постійні (0A) лишаються до завершення циклів без помилок.
+void clearCurrentDtcs(VehicleState &s);
+
+// Розгортає freeze frame у знімок стану для енкодерів PID (obd_pids.h).
+// Код кадру стає єдиним поточним DTC: його кодує PID 0x02 сервісу 02.
+void restoreFreezeFrame(const FreezeFrame &frame, VehicleState &out);
+
+// Завершений цикл їзди: рахує цикли без помилок і після CYCLES_THRESHOLD
+// очищує постійні DTC. true - якщо постійні коди щойно очищено.
+// Також оновлює лічильники IPT: з поточними DTC монітори не завершуються.
+bool applyDrivingCycle(VehicleState &s);
+
+// TCM: передача відповідає швидкості (поріг кожні 25 км/год), 0 - стоїмо.
+int gearForSpeed(int speed_kmh);
+
+// Параметри /update (назва -> значення). nullptr - параметра немає.
+class StateParams {
+public:
+    virtual ~StateParams() {}
+    virtual const char *get(const char *name) const = 0;
+};
+
+// Застосовує параметри форми /update до робочої копії стану (спільне для ESP32 та Linux).
+// Список DTC замінюється; freeze frames перебудовуються під новий список.
+void applyStateUpdate(VehicleState &s, const StateParams &params);
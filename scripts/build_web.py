@@ -0,0 +1,92 @@
+# Збирає веб-інтерфейс з web/ у data/ для LittleFS (pio run -t uploadfs)
+# та Linux-збірки: мінімізує HTML/CSS/JS і стискає gzip.
+#
+# Підключено в platformio.ini як extra_scripts = pre:scripts/build_web.py,
+# можна запускати й окремо: python3 scripts/build_web.py
+#
+# Мінімізація консервативна (без розбору JS): прибирає відступи, порожні рядки
+# та коментарі на окремих рядках - переноси рядків лишаються, тож семантика не змінюється.
+# gzip з mtime=0: однакові джерела дають однакові байти, а отже й той самий ETag.
+#
+# Траси поїздок з traces/ (*.csv, див. trace_player.h) копіюються в data/ як є:
+# прошивка читає їх рядок за рядком з LittleFS.
+
+import gzip
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 - визначено PlatformIO (SCons)
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SOURCE_DIR = os.path.join(PROJECT_DIR, "web")
+OUTPUT_DIR = os.path.join(PROJECT_DIR, "data")
+TRACES_DIR = os.path.join(PROJECT_DIR, "traces")
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line)
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    return re.sub(r"\s*([{};,])\s*", r"\1", text).strip()
+
+
+def minify_js(text):
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line and not line.startswith("//"))
+
+
+MINIFIERS = {
+    ".html": minify_html,
+    ".css": minify_css,
+    ".js": minify_js,
+}
+
+
+def write_if_changed(target, data):
+    if os.path.exists(target):
+        with open(target, "rb") as f:
+            if f.read() == data:
+                return False
+    with open(target, "wb") as f:
+        f.write(data)
+    return True
+
+
+def copy_traces():
+    if not os.path.isdir(TRACES_DIR):
+        return
+    for name in sorted(os.listdir(TRACES_DIR)):
+        if not name.endswith(".csv"):
+            continue
+        with open(os.path.join(TRACES_DIR, name), "rb") as f:
+            data = f.read()
+        if write_if_changed(os.path.join(OUTPUT_DIR, name), data):
+            print("web: traces/%s -> data/%s (%d bytes)" % (name, name, len(data)))
+
+
+def build():
+    os.makedirs(OUTPUT_DIR, exist_ok=True)
+    for name in sorted(os.listdir(SOURCE_DIR)):
+        minify = MINIFIERS.get(os.path.splitext(name)[1])
+        if minify is None:
+            continue
+        with open(os.path.join(SOURCE_DIR, name), encoding="utf-8") as f:
+            source = f.read()
+        data = gzip.compress(minify(source).encode("utf-8"), compresslevel=9, mtime=0)
+
+        # Перезаписуємо лише змінені файли, щоб не перезбирати образ LittleFS даремно
+        if not write_if_changed(os.path.join(OUTPUT_DIR, name + ".gz"), data):
+            continue
+        print("web: %s -> data/%s.gz (%d -> %d bytes)" % (name, name, len(source.encode("utf-8")), len(data)))
+    copy_traces()
+
+
+build()
@@ -0,0 +1,360 @@
+// Бенчмарк сесії сканера: симульований тестер працює з ядром OBD (lib/obd_core)
+// через петлевий CAN-транспорт у тому ж процесі - без шини, драйвера та потоків.
+//
+//   pio run -e bench && .pio/build/bench/program [--requests 200000] [--multi]
+//                                                 [--min-rps N] [--max-p99-us N]
+//
+// 1. Виявлення за J1979: бітові маски PID 0x00/0x20/0x40/0x60... (функціональні
+//    запити, відповідають усі ECU), сервіс 09 (маска, VIN через ISO-TP з Flow Control),
+//    сервіси 03 та 0A для кожного ECU.
+// 2. Безперервне опитування знайдених PID сервісу 01 (фізичні запити по колу).
+//
+// Затримка - реальний час від передачі запиту ядру до останнього кадру відповіді.
+// Протокольні затримки (відкладена відповідь TCM на 0x7DF, STmin) не очікуються:
+// віртуальний годинник одразу перескакує на найближчий таймер.
+// Для CI: --min-rps та --max-p99-us повертають код 1, якщо поріг не виконано.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "obd_ecu.h"
+#include "service01_pids.h"
+#include "service06_monitors.h"
+#include "service09_info.h"
+
+// ############## Петлевий транспорт ##############
+uint64_t realNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const int NUM_ECUS = 2;
+const uint32_t NO_TIMER = 0;
+
+class LoopbackHal : public ObdHal {
+public:
+    std::vector<CanFrame> inbox;     // Кадри від ECU до тестера
+    uint64_t skipped_us = 0;         // Наскільки віртуальний час випередив реальний
+    uint64_t deadlines[NUM_ECUS][2] = {}; // Віртуальні мкс, NO_TIMER - не заведено
+    VehicleState state;
+
+    uint64_t nowUs() { return realNs() / 1000 + skipped_us; }
+
+    uint32_t micros() override { return (uint32_t)nowUs(); }
+
+    bool transmit(const CanFrame &frame, uint8_t) override {
+        inbox.push_back(frame);
+        return true;
+    }
+
+    void armTimer(ObdEcu &ecu, ObdTimer timer, uint32_t delay_us) override {
+        deadlines[ecu.index()][timer] = nowUs() + delay_us;
+    }
+
+    void lock(ObdEcu &) override {}
+    void unlock(ObdEcu &) override {}
+
+    VehicleState readState() override { return state; }
+    void clearDtcs(ObdEcu &) override {}
+};
+
+LoopbackHal hal;
+
+ObdEcu ecus[NUM_ECUS] = {
+    //           name   request  response  service01        service02   service06   functional delay  DTC    service09
+    ObdEcuConfig{"ECM", 0x7E0,   0x7E8,    &SERVICE01,      &SERVICE02, &SERVICE06, 0,                true,  &SERVICE09},
+    ObdEcuConfig{"TCM", 0x7E1,   0x7E9,    &TCM_SERVICE01,  nullptr,    nullptr,    3000,             false, &TCM_SERVICE09},
+};
+
+// Запускає заведені таймери, перескакуючи віртуальним часом. false - таймерів немає.
+bool runNextTimer() {
+    int best_ecu = -1, best_timer = 0;
+    for (int i = 0; i < NUM_ECUS; i++) {
+        for (int t = 0; t < 2; t++) {
+            uint64_t d = hal.deadlines[i][t];
+            if (d != NO_TIMER && (best_ecu < 0 || d < hal.deadlines[best_ecu][best_timer])) {
+                best_ecu = i;
+                best_timer = t;
+            }
+        }
+    }
+    if (best_ecu < 0) return false;
+    uint64_t deadline = hal.deadlines[best_ecu][best_timer];
+    uint64_t now = hal.nowUs();
+    if (deadline > now) hal.skipped_us += deadline - now;
+    hal.deadlines[best_ecu][best_timer] = NO_TIMER;
+    ecus[best_ecu].onTimer((ObdTimer)best_timer);
+    return true;
+}
+
+// ############## Симульований тестер ##############
+struct Stats {
+    uint64_t requests = 0;
+    uint64_t frames_rx = 0;
+    uint64_t errors = 0;
+};
+Stats stats;
+
+CanFrame makeRequest(uint32_t id, const uint8_t *payload, uint8_t len) {
+    CanFrame frame = {};
+    frame.id = id;
+    frame.dlc = 8;
+    frame.data[0] = len;
+    memcpy(&frame.data[1], payload, len);
+    return frame;
+}
+
+int ecuOf(uint32_t response_id) {
+    for (int i = 0; i < NUM_ECUS; i++) {
+        if (ecus[i].config.response_id == response_id) return i;
+    }
+    return -1;
+}
+
+void send(const CanFrame &frame) {
+    dispatchObdFrame(ecus, NUM_ECUS, frame, hal.micros());
+}
+
+struct Response {
+    uint32_t id;
+    std::vector<uint8_t> payload;
+};
+
+// Приймає відповіді (SF або FF+CF з Flow Control) до тиші на шині.
+// Функціональний запит чекає і на відкладені відповіді (таймери ECU).
+std::vector<Response> collect() {
+    std::vector<Response> responses;
+    struct Pending { uint32_t id; size_t total; uint8_t next_sn; std::vector<uint8_t> data; };
+    std::vector<Pending> pending;
+
+    for (;;) {
+        while (!hal.inbox.empty()) {
+            std::vector<CanFrame> frames;
+            frames.swap(hal.inbox);
+            for (const CanFrame &f : frames) {
+                stats.frames_rx++;
+                uint8_t type = f.data[0] >> 4;
+                if (type == 0x0) {
+                    uint8_t len = f.data[0] & 0x0F;
+                    if (len == 0 || len > 7 || len + 1 > f.dlc) {
+                        stats.errors++;
+                        continue;
+                    }
+                    responses.push_back({f.id, std::vector<uint8_t>(&f.data[1], &f.data[1] + len)});
+                } else if (type == 0x1) {
+                    Pending p = {f.id, (size_t)((f.data[0] & 0x0F) << 8 | f.data[1]), 1,
+                                 std::vector<uint8_t>(&f.data[2], &f.data[8])};
+                    pending.push_back(p);
+                    // Flow Control від тестера: CTS, без блоків, STmin = 0
+                    int ecu = ecuOf(f.id);
+                    if (ecu < 0) {
+                        stats.errors++;
+                        continue;
+                    }
+                    CanFrame fc = {};
+                    fc.id = ecus[ecu].config.request_id;
+                    fc.dlc = 8;
+                    fc.data[0] = 0x30;
+                    send(fc);
+                } else if (type == 0x2) {
+                    auto it = std::find_if(pending.begin(), pending.end(),
+                                           [&](const Pending &p) { return p.id == f.id; });
+                    if (it == pending.end() || (f.data[0] & 0x0F) != (it->next_sn & 0x0F)) {
+                        stats.errors++;
+                        continue;
+                    }
+                    it->next_sn++;
+                    it->data.insert(it->data.end(), &f.data[1], &f.data[8]);
+                    if (it->data.size() >= it->total) {
+                        it->data.resize(it->total);
+                        responses.push_back({it->id, it->data});
+                        pending.erase(it);
+                    }
+                }
+            }
+        }
+        if (!runNextTimer()) break;
+    }
+    if (!pending.empty()) stats.errors++;
+    return responses;
+}
+
+std::vector<Response> request(uint32_t id, std::initializer_list<uint8_t> payload) {
+    std::vector<uint8_t> bytes(payload);
+    stats.requests++;
+    send(makeRequest(id, bytes.data(), bytes.size()));
+    return collect();
+}
+
+struct Discovered {
+    std::vector<uint8_t> pids; // Сервіс 01, без масок
+    std::string vin;
+    int dtcs = -1;
+    int permanent_dtcs = -1;
+};
+Discovered discovered[NUM_ECUS];
+
+void discover() {
+    // Маски сервісу 01: наступний діапазон запитується, поки хтось звітує біт 0x20
+    bool more = true;
+    for (uint8_t base = 0x00; more; base += 0x20) {
+        more = false;
+        for (const Response &r : request(OBD_FUNCTIONAL_ID, {0x01, base})) {
+            int ecu = ecuOf(r.id);
+            if (ecu < 0 || r.payload.size() != 6 || r.payload[0] != 0x41 || r.payload[1] != base) {
+                stats.errors++;
+                continue;
+            }
+            uint32_t mask = (uint32_t)r.payload[2] << 24 | r.payload[3] << 16 | r.payload[4] << 8 | r.payload[5];
+            for (int bit = 1; bit < 32; bit++) {
+                if (mask & (1UL << (32 - bit))) discovered[ecu].pids.push_back(base + bit);
+            }
+            if (mask & 1) more = true;
+        }
+        if (base == 0xE0) break;
+    }
+
+    request(OBD_FUNCTIONAL_ID, {0x09, 0x00});
+    for (const Response &r : request(ecus[0].config.request_id, {0x09, 0x02})) {
+        // 0x49 0x02, NODI = 1, 17 байтів VIN
+        if (r.payload.size() != 20 || r.payload[0] != 0x49 || r.payload[2] != 1) {
+            stats.errors++;
+            continue;
+        }
+        discovered[0].vin.assign(r.payload.begin() + 3, r.payload.end());
+    }
+    if (discovered[0].vin != hal.state.vin) stats.errors++;
+
+    for (int i = 0; i < NUM_ECUS; i++) {
+        for (const Response &r : request(ecus[i].config.request_id, {0x03})) {
+            if (r.payload.size() >= 2 && r.payload[0] == 0x43) discovered[i].dtcs = r.payload[1];
+        }
+        for (const Response &r : request(ecus[i].config.request_id, {0x0A})) {
+            if (r.payload.size() >= 2 && r.payload[0] == 0x4A) discovered[i].permanent_dtcs = r.payload[1];
+        }
+        if (discovered[i].dtcs < 0 || discovered[i].permanent_dtcs < 0) stats.errors++;
+    }
+}
+
+double percentile(std::vector<uint32_t> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--requests N] [--multi] [--min-rps N] [--max-p99-us N]\n"
+            "  --requests    polling requests after discovery (default 200000)\n"
+            "  --multi       poll up to 6 PIDs per request (ISO-TP responses)\n"
+            "  --min-rps     exit 1 if polling throughput is lower\n"
+            "  --max-p99-us  exit 1 if p99 polling latency is higher\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    long requests = 200000;
+    bool multi = false;
+    double min_rps = 0, max_p99_us = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            requests = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--multi") == 0) {
+            multi = true;
+        } else if (strcmp(argv[i], "--min-rps") == 0 && i + 1 < argc) {
+            min_rps = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-p99-us") == 0 && i + 1 < argc) {
+            max_p99_us = atof(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Стан, що змушує кожну гілку працювати: 3 DTC -> відповідь 03/0A багатокадрова
+    strcpy(hal.state.vin, "1HGCM82633A004352");
+    addDTC(hal.state, "P0300");
+    addDTC(hal.state, "P0171");
+    addDTC(hal.state, "P0420");
+    for (int i = 0; i < NUM_ECUS; i++) {
+        ecus[i].begin(hal, i);
+        ecus[i].rebuildCache(hal.state);
+    }
+
+    // --- Виявлення ---
+    uint64_t start = realNs();
+    discover();
+    uint64_t discovery_ns = realNs() - start;
+    // Віртуальний час включає і таймаути N_Bs, що лишаються заведеними після передачі
+    printf("discovery: %llu requests, %llu frames, %.1f us (ECU timers fast-forwarded by %.3f s), %llu errors\n",
+           (unsigned long long)stats.requests, (unsigned long long)stats.frames_rx, discovery_ns / 1000.0,
+           hal.skipped_us / 1e6, (unsigned long long)stats.errors);
+    for (int i = 0; i < NUM_ECUS; i++) {
+        printf("  %s 0x%03lX: %zu PIDs [", ecus[i].config.name, (unsigned long)rawCanId(ecus[i].config.response_id),
+               discovered[i].pids.size());
+        for (size_t p = 0; p < discovered[i].pids.size(); p++) printf(p ? " %02X" : "%02X", discovered[i].pids[p]);
+        printf("], DTCs %d, permanent %d%s%s\n", discovered[i].dtcs, discovered[i].permanent_dtcs,
+               discovered[i].vin.empty() ? "" : ", VIN ", discovered[i].vin.c_str());
+    }
+
+    // --- Опитування ---
+    struct Target { uint32_t id; uint8_t pids[MAX_PIDS_PER_REQUEST]; uint8_t count; };
+    std::vector<Target> targets;
+    for (int i = 0; i < NUM_ECUS; i++) {
+        const std::vector<uint8_t> &pids = discovered[i].pids;
+        size_t step = multi ? MAX_PIDS_PER_REQUEST : 1;
+        for (size_t p = 0; p < pids.size(); p += step) {
+            Target t = {ecus[i].config.request_id, {}, 0};
+            for (size_t k = p; k < pids.size() && t.count < step; k++) t.pids[t.count++] = pids[k];
+            targets.push_back(t);
+        }
+    }
+    if (targets.empty()) {
+        fprintf(stderr, "no PIDs discovered\n");
+        return 1;
+    }
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(requests);
+    const uint64_t errors_before = stats.errors;
+    uint8_t payload[1 + MAX_PIDS_PER_REQUEST];
+    payload[0] = 0x01;
+    start = realNs();
+    for (long n = 0; n < requests; n++) {
+        const Target &t = targets[n % targets.size()];
+        memcpy(&payload[1], t.pids, t.count);
+        const CanFrame frame = makeRequest(t.id, payload, 1 + t.count);
+        uint64_t t0 = realNs();
+        send(frame);
+        std::vector<Response> responses = collect();
+        latencies.push_back((uint32_t)(realNs() - t0));
+        if (responses.size() != 1 || responses[0].payload[0] != 0x41) stats.errors++;
+    }
+    const double polling_s = (realNs() - start) / 1e9;
+    const double rps = requests / polling_s;
+
+    std::sort(latencies.begin(), latencies.end());
+    const double p99 = percentile(latencies, 0.99);
+    printf("polling: %ld requests (%s) in %.3f s -> %.0f req/s, %llu errors\n", requests,
+           multi ? "multi-PID" : "single PID", polling_s, rps,
+           (unsigned long long)(stats.errors - errors_before));
+    printf("latency (us): p50 %.2f  p99 %.2f  p999 %.2f  max %.2f\n", percentile(latencies, 0.5), p99,
+           percentile(latencies, 0.999), latencies.empty() ? 0 : latencies.back() / 1000.0);
+
+    bool ok = stats.errors == 0;
+    if (min_rps > 0 && rps < min_rps) {
+        printf("FAIL: %.0f req/s < %.0f\n", rps, min_rps);
+        ok = false;
+    }
+    if (max_p99_us > 0 && p99 > max_p99_us) {
+        printf("FAIL: p99 %.2f us > %.2f\n", p99, max_p99_us);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,439 @@
+#include "http_server.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace {
+
+// ############## SHA-1 + Base64 для рукостискання WebSocket (RFC 6455) ##############
+inline uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+void sha1(const uint8_t *data, size_t len, uint8_t out[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string msg((const char *)data, len);
+    msg += (char)0x80;
+    while (msg.size() % 64 != 56) msg += (char)0x00;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 7; i >= 0; i--) msg += (char)((bits >> (i * 8)) & 0xFF);
+
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t *p = (const uint8_t *)&msg[chunk + i * 4];
+            w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        out[i * 4] = h[i] >> 24;
+        out[i * 4 + 1] = h[i] >> 16;
+        out[i * 4 + 2] = h[i] >> 8;
+        out[i * 4 + 3] = h[i];
+    }
+}
+
+std::string base64(const uint8_t *data, size_t len) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out += ALPHABET[(v >> 18) & 0x3F];
+        out += ALPHABET[(v >> 12) & 0x3F];
+        out += i + 1 < len ? ALPHABET[(v >> 6) & 0x3F] : '=';
+        out += i + 2 < len ? ALPHABET[v & 0x3F] : '=';
+    }
+    return out;
+}
+
+std::string urlDecode(const std::string &s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size()) {
+            char hex[3] = {s[i + 1], s[i + 2], 0};
+            out += (char)strtol(hex, nullptr, 16);
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+void parseQuery(const std::string &query, std::map<std::string, std::string> &params) {
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t amp = query.find('&', start);
+        if (amp == std::string::npos) amp = query.size();
+        std::string pair = query.substr(start, amp - start);
+        size_t eq = pair.find('=');
+        if (eq == std::string::npos) {
+            params[urlDecode(pair)] = "";
+        } else {
+            params[urlDecode(pair.substr(0, eq))] = urlDecode(pair.substr(eq + 1));
+        }
+        start = amp + 1;
+    }
+}
+
+// Заголовки після рядка запиту; назви приводяться до нижнього регістру.
+void parseHeaders(const std::string &head, std::map<std::string, std::string> &headers) {
+    size_t pos = head.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < head.size()) {
+        size_t line = pos + 2;
+        size_t end = head.find("\r\n", line);
+        if (end == std::string::npos) end = head.size();
+        size_t colon = head.find(':', line);
+        if (colon != std::string::npos && colon < end) {
+            std::string name = head.substr(line, colon - line);
+            for (char &c : name) c = tolower((unsigned char)c);
+            size_t v = colon + 1;
+            while (v < end && head[v] == ' ') v++;
+            headers[name] = head.substr(v, end - v);
+        }
+        pos = end;
+    }
+}
+
+const char *statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+} // namespace
+
+HttpServer::~HttpServer() {
+    for (auto &entry : connections_) ::close(entry.first);
+    if (listenFd_ >= 0) ::close(listenFd_);
+}
+
+bool HttpServer::begin(uint16_t port, int epoll_fd) {
+    epollFd_ = epoll_fd;
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(listenFd_, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd_, 16) < 0) {
+        return false;
+    }
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd_;
+    return epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev) == 0;
+}
+
+bool HttpServer::handleEvent(int fd, uint32_t events) {
+    if (fd == listenFd_) {
+        accept();
+        return true;
+    }
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return false;
+
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(fd);
+        return true;
+    }
+    if (events & EPOLLIN) {
+        onReadable(fd, it->second);
+        it = connections_.find(fd);
+        if (it == connections_.end()) return true;
+    }
+    flush(fd, it->second);
+
+    // Після відправки 101: обробник може одразу надіслати клієнту початковий стан
+    it = connections_.find(fd);
+    if (it != connections_.end() && it->second.ws_connect_pending) {
+        it->second.ws_connect_pending = false;
+        if (wsConnect_) wsConnect_(fd);
+    }
+    // Повідомлення клієнта - теж після flush: обробник може відповісти або закрити з'єднання
+    it = connections_.find(fd);
+    if (it != connections_.end() && !it->second.ws_messages.empty()) {
+        std::vector<std::string> messages;
+        messages.swap(it->second.ws_messages);
+        for (const std::string &message : messages) {
+            if (wsMessage_ && connections_.count(fd)) wsMessage_(fd, message);
+        }
+    }
+    return true;
+}
+
+void HttpServer::accept() {
+    for (;;) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN - прийнято всіх
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = Connection();
+    }
+}
+
+void HttpServer::onReadable(int fd, Connection &conn) {
+    char buf[4096];
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n > 0) {
+            conn.in.append(buf, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeConnection(fd);
+            return;
+        }
+        break;
+    }
+
+    if (conn.websocket) {
+        handleWsFrames(conn);
+    } else if (!handleHttp(conn) && conn.in.size() > MAX_REQUEST) {
+        conn.out = "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+        conn.close_after_write = true;
+    }
+    if (conn.websocket && conn.in.size() > MAX_WS_MESSAGE + 14) {
+        closeConnection(fd);
+    }
+}
+
+bool HttpServer::handleHttp(Connection &conn) {
+    size_t head_end = conn.in.find("\r\n\r\n");
+    if (head_end == std::string::npos) return false;
+    const std::string head = conn.in.substr(0, head_end);
+    conn.in.erase(0, head_end + 4);
+
+    // Рядок запиту: GET /path?query HTTP/1.1
+    size_t sp1 = head.find(' ');
+    size_t sp2 = sp1 == std::string::npos ? std::string::npos : head.find(' ', sp1 + 1);
+    HttpResponse response;
+    HttpRequest request;
+    if (sp2 == std::string::npos) {
+        response.status = 400;
+    } else if (head.compare(0, sp1, "GET") != 0) {
+        response.status = 405;
+    } else {
+        std::string target = head.substr(sp1 + 1, sp2 - sp1 - 1);
+        size_t q = target.find('?');
+        request.path = urlDecode(target.substr(0, q));
+        if (q != std::string::npos) parseQuery(target.substr(q + 1), request.params);
+        parseHeaders(head, request.headers);
+
+        const char *upgrade = request.header("upgrade");
+        if (request.path == "/ws" && upgrade && strcasecmp(upgrade, "websocket") == 0) {
+            const char *key_header = request.header("sec-websocket-key");
+            std::string key = key_header ? key_header : "";
+            if (key.empty()) {
+                response.status = 400;
+            } else {
+                key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+                uint8_t digest[20];
+                sha1((const uint8_t *)key.data(), key.size(), digest);
+                conn.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                            "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+                conn.websocket = true;
+                conn.ws_connect_pending = true;
+                handleWsFrames(conn);
+                return true;
+            }
+        } else {
+            auto handler = handlers_.find(request.path);
+            if (handler == handlers_.end()) {
+                response.status = 404;
+                response.body = "Not found";
+            } else {
+                handler->second(request, response);
+            }
+        }
+    }
+
+    char header[256];
+    snprintf(header, sizeof(header),
+             "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n",
+             response.status, statusText(response.status), response.content_type.c_str(), response.body.size());
+    conn.out += header;
+    for (const auto &extra : response.headers) conn.out += extra.first + ": " + extra.second + "\r\n";
+    conn.out += "\r\n";
+    conn.out += response.body;
+    conn.close_after_write = true;
+    return true;
+}
+
+// Кадри від клієнта завжди замасковані. Обробляються Close, Ping та текстові
+// повідомлення (лише цілі, без фрагментації - команди клієнта короткі).
+void HttpServer::handleWsFrames(Connection &conn) {
+    for (;;) {
+        const uint8_t *p = (const uint8_t *)conn.in.data();
+        size_t avail = conn.in.size();
+        if (avail < 2) return;
+        bool fin = p[0] & 0x80;
+        uint8_t opcode = p[0] & 0x0F;
+        uint64_t len = p[1] & 0x7F;
+        size_t pos = 2;
+        if (len == 126) {
+            if (avail < 4) return;
+            len = ((uint64_t)p[2] << 8) | p[3];
+            pos = 4;
+        } else if (len == 127) {
+            if (avail < 10) return;
+            len = 0;
+            for (int i = 0; i < 8; i++) len = (len << 8) | p[2 + i];
+            pos = 10;
+        }
+        bool masked = p[1] & 0x80;
+        if (len > MAX_WS_MESSAGE || !masked) {
+            conn.in.clear();
+            conn.close_after_write = true;
+            queueWsFrame(conn, 0x8, nullptr, 0);
+            return;
+        }
+        if (avail < pos + 4 + len) return;
+
+        const uint8_t *mask = p + pos;
+        std::string payload(len, '\0');
+        for (size_t i = 0; i < len; i++) payload[i] = p[pos + 4 + i] ^ mask[i % 4];
+        conn.in.erase(0, pos + 4 + len);
+
+        if (opcode == 0x8) {
+            queueWsFrame(conn, 0x8, payload.data(), payload.size() < 2 ? payload.size() : 2);
+            conn.close_after_write = true;
+            return;
+        }
+        // Pong - лише якщо клієнт читає: інакше ping-и теж наповнювали б чергу
+        if (opcode == 0x9 && conn.out.size() < MAX_WS_PENDING) queueWsFrame(conn, 0xA, payload.data(), payload.size());
+        if (opcode == 0x1 && fin) conn.ws_messages.push_back(payload);
+    }
+}
+
+void HttpServer::queueWsFrame(Connection &conn, uint8_t opcode, const char *data, size_t len) {
+    conn.out += (char)(0x80 | opcode);
+    if (len < 126) {
+        conn.out += (char)len;
+    } else if (len <= 0xFFFF) {
+        conn.out += (char)126;
+        conn.out += (char)(len >> 8);
+        conn.out += (char)(len & 0xFF);
+    } else {
+        conn.out += (char)127;
+        for (int i = 7; i >= 0; i--) conn.out += (char)(((uint64_t)len >> (i * 8)) & 0xFF);
+    }
+    conn.out.append(data ? data : "", len);
+}
+
+void HttpServer::flush(int fd, Connection &conn) {
+    while (!conn.out.empty()) {
+        ssize_t n = write(fd, conn.out.data(), conn.out.size());
+        if (n > 0) {
+            conn.out.erase(0, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(fd);
+        return;
+    }
+    if (conn.out.empty() && conn.close_after_write) {
+        closeConnection(fd);
+        return;
+    }
+    epoll_event ev = {};
+    ev.events = conn.out.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT);
+    ev.data.fd = fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void HttpServer::closeConnection(int fd) {
+    auto it = connections_.find(fd);
+    bool websocket = it != connections_.end() && it->second.websocket;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections_.erase(fd);
+    if (websocket && wsDisconnect_) wsDisconnect_(fd);
+}
+
+void HttpServer::textAll(const std::string &text) {
+    // flush() може закрити з'єднання - спершу збираємо дескриптори
+    std::vector<int> clients;
+    for (auto &entry : connections_) {
+        if (entry.second.websocket && !entry.second.close_after_write) clients.push_back(entry.first);
+    }
+    for (int fd : clients) this->text(fd, text);
+}
+
+bool HttpServer::text(int client, const std::string &text) {
+    return sendWsMessage(client, 0x1, text.data(), text.size());
+}
+
+bool HttpServer::binary(int client, const uint8_t *data, size_t len) {
+    return sendWsMessage(client, 0x2, (const char *)data, len);
+}
+
+bool HttpServer::sendWsMessage(int client, uint8_t opcode, const char *data, size_t len) {
+    auto it = connections_.find(client);
+    if (it == connections_.end() || !it->second.websocket) return false;
+    if (it->second.out.size() + len > MAX_WS_PENDING) return false;
+    queueWsFrame(it->second, opcode, data, len);
+    flush(client, it->second);
+    return true;
+}
+
+size_t HttpServer::wsClientCount() const {
+    size_t count = 0;
+    for (const auto &entry : connections_) {
+        if (entry.second.websocket) count++;
+    }
+    return count;
+}
+
+std::vector<int> HttpServer::wsClients() const {
+    std::vector<int> clients;
+    for (const auto &entry : connections_) {
+        if (entry.second.websocket && !entry.second.close_after_write) clients.push_back(entry.first);
+    }
+    return clients;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ############## HTTP + WebSocket сервер (Linux) ##############
+// Мінімальна заміна ESPAsyncWebServer для Linux-збірки: GET-запити з параметрами
+// в URL та WebSocket /ws: стан емулятора від сервера, короткі текстові команди від клієнта.
+// Однопотоковий, на неблокувальних сокетах: власник додає його дескриптори
+// в свій epoll і передає події в handleEvent(). Кожна HTTP-відповідь закриває з'єднання.
+
+struct HttpRequest {
+    std::string path;
+    std::map<std::string, std::string> params;
+    std::map<std::string, std::string> headers; // Назви - в нижньому регістрі
+
+    // nullptr - параметра немає
+    const char *param(const char *name) const {
+        auto it = params.find(name);
+        return it == params.end() ? nullptr : it->second.c_str();
+    }
+
+    // name - в нижньому регістрі; nullptr - заголовка немає
+    const char *header(const char *name) const {
+        auto it = headers.find(name);
+        return it == headers.end() ? nullptr : it->second.c_str();
+    }
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "text/plain";
+    std::vector<std::pair<std::string, std::string>> headers; // Додаткові заголовки
+    std::string body;
+};
+
+class HttpServer {
+public:
+    typedef std::function<void(const HttpRequest &, HttpResponse &)> Handler;
+    typedef std::function<void(int client)> WsConnectHandler;
+    typedef std::function<void(int client, const std::string &message)> WsMessageHandler;
+
+    static const size_t MAX_REQUEST = 8192;
+    static const size_t MAX_WS_MESSAGE = 4096;
+    // Неприйняті клієнтом дані: понад цю межу нові повідомлення відкидаються
+    // (вкладка у фоні, заповнене TCP-вікно), щоб черга не росла без кінця.
+    static const size_t MAX_WS_PENDING = 65536;
+
+    ~HttpServer();
+
+    // Слухає 0.0.0.0:port; дескриптори реєструються в epoll_fd.
+    bool begin(uint16_t port, int epoll_fd);
+
+    void on(const char *path, Handler handler) { handlers_[path] = handler; }
+    void onWsConnect(WsConnectHandler handler) { wsConnect_ = handler; }
+    void onWsDisconnect(WsConnectHandler handler) { wsDisconnect_ = handler; }
+    void onWsMessage(WsMessageHandler handler) { wsMessage_ = handler; }
+
+    // false - дескриптор не належить серверу.
+    bool handleEvent(int fd, uint32_t events);
+
+    void textAll(const std::string &text);
+    // false - повідомлення не поставлено в чергу (клієнта немає або черга переповнена);
+    // власник має відновити стан клієнта пізніше, напр. ключовим кадром.
+    bool text(int client, const std::string &text);
+    bool binary(int client, const uint8_t *data, size_t len);
+    size_t wsClientCount() const;
+    std::vector<int> wsClients() const;
+
+private:
+    struct Connection {
+        std::string in;
+        std::string out;
+        bool websocket = false;
+        bool close_after_write = false;
+        bool ws_connect_pending = false;
+        std::vector<std::string> ws_messages; // Текстові повідомлення для wsMessage_
+    };
+
+    void accept();
+    void onReadable(int fd, Connection &conn);
+    bool handleHttp(Connection &conn); // false - запит ще не повний
+    void handleWsFrames(Connection &conn);
+    void flush(int fd, Connection &conn);
+    void closeConnection(int fd);
+    void queueWsFrame(Connection &conn, uint8_t opcode, const char *data, size_t len);
+    bool sendWsMessage(int client, uint8_t opcode, const char *data, size_t len);
+
+    int listenFd_ = -1;
+    int epollFd_ = -1;
+    std::map<int, Connection> connections_;
+    std::map<std::string, Handler> handlers_;
+    WsConnectHandler wsConnect_;
+    WsConnectHandler wsDisconnect_;
+    WsMessageHandler wsMessage_;
+};
@@ -0,0 +1,738 @@
+// Linux-версія емулятора: те саме ядро OBD (lib/obd_core), що й у прошивці ESP32,
+// але на SocketCAN замість TWAI і з тим самим веб-інтерфейсом в одному процесі.
+//
+//   sudo modprobe vcan
+//   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+//   pio run -e linux && .pio/build/linux/program --iface vcan0 --port 8080
+//   (з кореня проєкту: веб-інтерфейс - data/, його збирає scripts/build_web.py)
+//   cansend vcan0 7DF#02010C0000000000 ; candump vcan0
+//
+// Один потік і epoll: CAN-сокет, timerfd для таймерів ECU та HTTP/WebSocket.
+// Кілька екземплярів на одній машині - різні інтерфейси (vcan0, vcan1 ...) і порти.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <set>
+#include <string>
+
+#include "../web_assets.h"
+#include "event_log.h"
+#include "http_server.h"
+#include "obd_ecu.h"
+#include "service01_pids.h"
+#include "service06_monitors.h"
+#include "service09_info.h"
+#include "socketcan.h"
+#include "state_json.h"
+#include "telemetry.h"
+#include "trace_player.h"
+#include "tx_queue.h"
+#include "vehicle_sim.h"
+#include "vehicle_state.h"
+
+// ############## Передача CAN ##############
+// Як у прошивці: кадр іде в сокет одразу, а якщо черга інтерфейсу заповнена (ENOBUFS) -
+// у програмну чергу з дедлайном. ENOBUFS не будить epoll (сокет лишається
+// "записуваним"), тож черга доливається за таймером TX_RETRY_US.
+const uint32_t TX_DEADLINE_US = 50000; // P2CAN: пізніша відповідь тестеру вже не потрібна
+const uint32_t TX_RETRY_US = 200;
+const int MAX_EPOLL_EVENTS = 32;
+
+struct CanCounters {
+    uint64_t rx;
+    uint64_t tx_direct; // Одразу в сокет
+    uint64_t tx_failed; // Помилка сокета (інтерфейс зник, down)
+};
+
+SocketCan can_bus;
+TxQueue tx_queue;
+CanCounters can_counters = {};
+
+// ############## Стан автомобіля ##############
+// Усе виконується в одному потоці, тож знімки (SeqLock) та м'ютекси не потрібні:
+// зміни - через updateVehicleState(), яка перебудовує кеш відповідей ECU.
+VehicleState state;
+bool ui_refresh_pending = false;
+
+EventLog event_log;
+HttpServer http;
+std::set<int> ws_binary_clients; // Клієнти, що попросили бінарну телеметрію ("bin")
+VehicleState ws_json_sent;       // Від цього стану рахуються JSON-дельти
+
+// Як у прошивці: JSON-клієнти отримують ключовий кадр (усі поля) раз на
+// WS_KEYFRAME_INTERVAL_US і після будь-якого відкинутого повідомлення
+// (черга HttpServer обмежена, див. MAX_WS_PENDING), між ними - лише дельти.
+const uint64_t WS_KEYFRAME_INTERVAL_US = 10000000;
+const uint64_t WS_RESYNC_INTERVAL_US = 500000; // Повтор для клієнтів, що чекають ключовий кадр
+std::set<int> ws_keyframe_clients;  // Наступне JSON-повідомлення - ключовий кадр
+uint64_t last_keyframe_us = 0;
+
+int epoll_fd = -1;
+int timer_fd = -1;
+volatile sig_atomic_t stop_requested = 0;
+
+// Дедлайни одноразових таймерів (мкс монотонного часу), 0 - не заведено.
+// Один timerfd заводиться на найближчий з них.
+const int NUM_ECUS = 2;
+uint64_t ecu_deadlines[NUM_ECUS][2] = {}; // Індекс - ObdTimer
+uint64_t tx_retry_deadline = 0;
+uint64_t sim_deadline = 0;
+uint64_t keyframe_deadline = 0; // Будить notifyClients() для ключових кадрів
+
+// ############## Симуляція ##############
+// Траса або модель руху (vehicle_sim.h, коли ввімкнено dynamic_rpm) з фіксованим
+// кроком за тим самим timerfd. Поки симуляція йде, веб-клієнти отримують
+// оновлення не частіше SIM_NOTIFY_INTERVAL_US, а не на кожному кроці.
+const uint64_t SIM_STEP_US = VehicleSim::STEP_MS * 1000;
+const uint64_t SIM_NOTIFY_INTERVAL_US = 50000;
+VehicleSim vehicle_sim;
+bool model_running = false;
+
+// CSV-траса (trace_player.h): --trace при старті або /trace?file=...[&speed=2][&loop=0],
+// /trace?stop. Має пріоритет над моделлю.
+
+class FileTraceReader : public TraceReader {
+public:
+    ~FileTraceReader() { close(); }
+    bool open(const char *path) {
+        close();
+        file_ = fopen(path, "r");
+        return file_ != nullptr;
+    }
+    void close() {
+        if (file_) fclose(file_);
+        file_ = nullptr;
+    }
+    bool readLine(char *buf, size_t size) override {
+        if (!file_ || !fgets(buf, (int)size, file_)) return false;
+        size_t len = strcspn(buf, "\r\n");
+        if (buf[len] == '\0' && len == size - 1) {
+            // Задовгий рядок: решту пропускаємо
+            int c;
+            while ((c = fgetc(file_)) != EOF && c != '\n') {}
+        }
+        buf[len] = '\0';
+        return true;
+    }
+    bool rewind() override { return file_ && fseek(file_, 0, SEEK_SET) == 0; }
+
+private:
+    FILE *file_ = nullptr;
+};
+
+FileTraceReader trace_reader;
+TracePlayer trace_player;
+
+// ############## Прототипи функцій ##############
+uint64_t monotonicUs();
+bool canTransmit(const CanFrame &frame, uint8_t priority);
+void pumpTxQueue();
+void scheduleTxRetry();
+void rearmTimer();
+void onTimerExpired();
+void receiveCanFrames();
+bool startTrace(const char *path, float speed, bool loop);
+void stopTrace();
+bool stepTrace();
+void scheduleSimulation();
+void stepSimulation();
+template <typename Fn> void updateVehicleState(Fn modify);
+void logEvent(LogEventType type, uint8_t ecu = LOG_NO_ECU, uint32_t value = 0,
+              uint8_t service = 0, uint8_t pid = 0, uint8_t count = 0, uint16_t length = 0);
+void drainLog();
+void setupWebServer(const char *web_root);
+std::string getJsonState();
+void notifyClients();
+std::string getCanStatsJson();
+
+class LinuxObdHal : public ObdHal {
+public:
+    uint32_t micros() override { return (uint32_t)monotonicUs(); }
+
+    bool transmit(const CanFrame &frame, uint8_t priority) override {
+        return canTransmit(frame, priority);
+    }
+
+    void armTimer(ObdEcu &ecu, ObdTimer timer, uint32_t delay_us) override {
+        ecu_deadlines[ecu.index()][timer] = monotonicUs() + delay_us;
+        rearmTimer();
+    }
+
+    // Один потік - блокування не потрібні
+    void lock(ObdEcu &) override {}
+    void unlock(ObdEcu &) override {}
+
+    VehicleState readState() override { return state; }
+
+    void clearDtcs(ObdEcu &) override {
+        updateVehicleState([](VehicleState &s) { clearCurrentDtcs(s); });
+    }
+
+    void log(const LogEvent &event) override {
+        if (event_log.enabled((LogEventType)event.type)) event_log.push(event);
+    }
+};
+
+LinuxObdHal obd_hal;
+
+// Ті самі ECU, що й у прошивці (src/main.cpp)
+ObdEcu ecus[NUM_ECUS] = {
+    //           name   request  response  service01        service02   service06   functional delay  DTC    service09
+    ObdEcuConfig{"ECM", 0x7E0,   0x7E8,    &SERVICE01,      &SERVICE02, &SERVICE06, 0,                true,  &SERVICE09},
+    ObdEcuConfig{"TCM", 0x7E1,   0x7E9,    &TCM_SERVICE01,  nullptr,    nullptr,    3000,             false, &TCM_SERVICE09},
+};
+
+// Параметри HTTP-запиту /update для applyStateUpdate()
+class HttpRequestParams : public StateParams {
+public:
+    explicit HttpRequestParams(const HttpRequest &request) : request_(request) {}
+    const char *get(const char *name) const override { return request_.param(name); }
+
+private:
+    const HttpRequest &request_;
+};
+
+void onSignal(int) {
+    stop_requested = 1;
+}
+
+void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--iface vcan0] [--port 8080] [--web-root data] [--log 0..3]\n"
+            "          [--trace FILE.csv] [--trace-speed 1.0] [--trace-once]\n"
+            "  --iface     SocketCAN interface (vcan0, can0, slcan0 ...)\n"
+            "  --port      HTTP/WebSocket port, 0 disables the web interface\n"
+            "  --web-root  Directory with the gzipped web UI (scripts/build_web.py)\n"
+            "  --log       0 OFF, 1 ERROR, 2 INFO, 3 DEBUG (every received frame)\n"
+            "  --trace     Play a recorded drive trace (CSV, see trace_player.h)\n"
+            "  --trace-speed  Playback speed multiplier\n"
+            "  --trace-once   Stop at the end of the trace instead of looping\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    const char *iface = "vcan0";
+    int port = 8080;
+    const char *web_root = "data";
+    int log_level = LOG_INFO;
+    const char *trace_path = nullptr;
+    float trace_speed = 1.0f;
+    bool trace_loop = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iface") == 0 && i + 1 < argc) {
+            iface = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--web-root") == 0 && i + 1 < argc) {
+            web_root = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-speed") == 0 && i + 1 < argc) {
+            trace_speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--trace-once") == 0) {
+            trace_loop = false;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (port < 0 || port > 65535 || log_level < LOG_OFF || log_level > LOG_DEBUG || trace_speed <= 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    event_log.setLevel((LogLevel)log_level);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    printf("OBD-II Emulator-A (Linux) starting...\n");
+
+    struct sigaction sa = {};
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    // --- Налаштування CAN ---
+    if (!can_bus.open(iface)) {
+        fprintf(stderr, "Failed to open SocketCAN interface %s: %s\n", iface, strerror(errno));
+        return 1;
+    }
+    // Ядро Linux пропускає лише запити до віртуальних ECU - точно, без надмножини TWAI
+    uint32_t ids[2 * NUM_ECUS];
+    size_t id_count = 0;
+    for (const ObdEcu &ecu : ecus) {
+        for (uint32_t id : {ecu.config.request_id, ecu.functionalId()}) {
+            bool seen = false;
+            for (size_t i = 0; i < id_count; i++) seen |= ids[i] == id;
+            if (!seen) ids[id_count++] = id;
+        }
+    }
+    if (!can_bus.setFilter(ids, id_count)) {
+        fprintf(stderr, "Failed to set CAN_RAW_FILTER: %s\n", strerror(errno));
+        return 1;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epoll_fd < 0 || timer_fd < 0) {
+        perror("epoll/timerfd");
+        return 1;
+    }
+    for (int fd : {can_bus.fd(), timer_fd}) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+    printf("SocketCAN %s opened, %zu IDs in the kernel filter.\n", iface, id_count);
+
+    for (int i = 0; i < NUM_ECUS; i++) {
+        ObdEcu &ecu = ecus[i];
+        ecu.begin(obd_hal, i);
+        ecu.rebuildCache(state);
+        printf("Virtual ECU %s: request 0x%03lX, response 0x%03lX%s\n", ecu.config.name,
+               (unsigned long)rawCanId(ecu.config.request_id), (unsigned long)rawCanId(ecu.config.response_id),
+               isExtendedCanId(ecu.config.request_id) ? " (29-bit)" : "");
+    }
+
+    if (trace_path && !startTrace(trace_path, trace_speed, trace_loop)) return 1;
+
+    // --- Налаштування веб-сервера ---
+    if (port != 0) {
+        if (!http.begin(port, epoll_fd)) {
+            fprintf(stderr, "Failed to listen on port %d: %s\n", port, strerror(errno));
+            return 1;
+        }
+        setupWebServer(web_root);
+        printf("Web server started on http://0.0.0.0:%d/\n", port);
+    }
+
+    epoll_event events[MAX_EPOLL_EVENTS];
+    uint64_t last_notify_us = 0;
+    while (!stop_requested) {
+        int n = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == can_bus.fd()) {
+                receiveCanFrames();
+            } else if (fd == timer_fd) {
+                onTimerExpired();
+            } else {
+                http.handleEvent(fd, events[i].events);
+            }
+        }
+        scheduleSimulation();
+        const uint64_t now = monotonicUs();
+        if (ui_refresh_pending && (sim_deadline == 0 || now - last_notify_us >= SIM_NOTIFY_INTERVAL_US)) {
+            ui_refresh_pending = false;
+            last_notify_us = now;
+            notifyClients();
+        }
+        drainLog();
+    }
+    printf("Stopped.\n");
+    return 0;
+}
+
+uint64_t monotonicUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Вичерпує сокет: функціональні (0x7DF) та фізичні запити до віртуальних ECU.
+void receiveCanFrames() {
+    CanFrame frame;
+    for (;;) {
+        SocketCan::Result result = can_bus.read(frame);
+        if (result == SocketCan::WOULD_BLOCK) return;
+        if (result == SocketCan::FAILED) {
+            fprintf(stderr, "SocketCAN read failed: %s\n", strerror(errno));
+            stop_requested = 1;
+            return;
+        }
+        const uint32_t rx_us = obd_hal.micros();
+        can_counters.rx++;
+        logEvent(EVT_CAN_RX, LOG_NO_ECU, frame.id, 0, 0, 0, frame.dlc);
+        dispatchObdFrame(ecus, NUM_ECUS, frame, rx_us);
+    }
+}
+
+// Передає кадр без очікування. priority: 0 - найвищий (індекс ECU).
+bool canTransmit(const CanFrame &frame, uint8_t priority) {
+    // Поки в програмній черзі щось є, нові кадри стають за ними - порядок ISO-TP зберігається
+    if (tx_queue.empty()) {
+        SocketCan::Result result = can_bus.write(frame);
+        if (result == SocketCan::OK) {
+            can_counters.tx_direct++;
+            return true;
+        }
+        if (result == SocketCan::FAILED) {
+            can_counters.tx_failed++;
+            return false;
+        }
+    }
+    bool ok = tx_queue.push(frame, priority, obd_hal.micros() + TX_DEADLINE_US);
+    scheduleTxRetry();
+    return ok;
+}
+
+void pumpTxQueue() {
+    CanFrame frame;
+    while (tx_queue.front(obd_hal.micros(), frame)) {
+        SocketCan::Result result = can_bus.write(frame);
+        if (result == SocketCan::WOULD_BLOCK) {
+            scheduleTxRetry();
+            return;
+        }
+        if (result == SocketCan::FAILED) can_counters.tx_failed++;
+        tx_queue.popFront();
+    }
+}
+
+void scheduleTxRetry() {
+    if (tx_retry_deadline != 0) return;
+    tx_retry_deadline = monotonicUs() + TX_RETRY_US;
+    rearmTimer();
+}
+
+// Заводить timerfd на найближчий дедлайн (або вимикає, якщо таймерів немає).
+void rearmTimer() {
+    uint64_t next = tx_retry_deadline;
+    if (sim_deadline != 0 && (next == 0 || sim_deadline < next)) next = sim_deadline;
+    if (keyframe_deadline != 0 && (next == 0 || keyframe_deadline < next)) next = keyframe_deadline;
+    for (int i = 0; i < NUM_ECUS; i++) {
+        for (uint64_t deadline : ecu_deadlines[i]) {
+            if (deadline != 0 && (next == 0 || deadline < next)) next = deadline;
+        }
+    }
+    itimerspec spec = {};
+    spec.it_value.tv_sec = next / 1000000ULL;
+    spec.it_value.tv_nsec = (next % 1000000ULL) * 1000;
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void onTimerExpired() {
+    uint64_t expirations;
+    while (read(timer_fd, &expirations, sizeof(expirations)) > 0) {}
+
+    const uint64_t now = monotonicUs();
+    for (int i = 0; i < NUM_ECUS; i++) {
+        for (int timer = 0; timer < 2; timer++) {
+            uint64_t &deadline = ecu_deadlines[i][timer];
+            if (deadline == 0 || deadline > now) continue;
+            deadline = 0;
+            ecus[i].onTimer((ObdTimer)timer); // Може знову завести цей таймер
+        }
+    }
+    if (tx_retry_deadline != 0 && tx_retry_deadline <= now) {
+        tx_retry_deadline = 0;
+        pumpTxQueue();
+    }
+    if (sim_deadline != 0 && sim_deadline <= now) {
+        stepSimulation(); // Заводить наступний крок
+    }
+    if (keyframe_deadline != 0 && keyframe_deadline <= now) {
+        keyframe_deadline = 0;
+        ui_refresh_pending = true;
+    }
+    rearmTimer();
+}
+
+bool startTrace(const char *path, float speed, bool loop) {
+    stopTrace();
+    if (!trace_reader.open(path)) {
+        fprintf(stderr, "Failed to open trace %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (!trace_player.begin(trace_reader, monotonicUs(), speed, loop)) {
+        fprintf(stderr, "Bad trace %s: %s\n", path, trace_player.error());
+        trace_reader.close();
+        return false;
+    }
+    printf("Trace %s started (x%.2f%s)\n", path, speed, loop ? ", loop" : "");
+    return true;
+}
+
+void stopTrace() {
+    trace_player.stop();
+    trace_reader.close();
+}
+
+// false - траса не грає.
+bool stepTrace() {
+    if (!trace_player.active()) return false;
+    const bool playing = trace_player.advance(monotonicUs());
+    int added = 0;
+    updateVehicleState([&](VehicleState &s) { added = trace_player.apply(s); });
+    // Нові коди addDTC() дописує в кінець списку
+    for (int i = state.num_dtcs - added; i < state.num_dtcs; i++) {
+        uint8_t code[2];
+        encodeDtc(state.dtcs[i], code);
+        logEvent(EVT_DTC_ADDED, LOG_NO_ECU, (code[0] << 8) | code[1]);
+    }
+    if (!playing) {
+        printf("Trace finished: %lu ms, %lu lines skipped\n",
+               (unsigned long)trace_player.positionMs(), (unsigned long)trace_player.skippedLines());
+        stopTrace();
+    }
+    return true;
+}
+
+// Заводить крок симуляції, якщо є що симулювати, а таймер ще не заведено.
+void scheduleSimulation() {
+    if (sim_deadline != 0 || !(trace_player.active() || state.dynamic_rpm_enabled)) return;
+    sim_deadline = monotonicUs() + SIM_STEP_US;
+    rearmTimer();
+}
+
+void stepSimulation() {
+    const bool trace_running = stepTrace();
+    const bool model_was_running = model_running;
+    model_running = !trace_running && state.dynamic_rpm_enabled;
+    if (model_running) {
+        const char *new_dtc = nullptr;
+        updateVehicleState([&](VehicleState &s) {
+            if (!model_was_running) vehicle_sim.reset(s);
+            new_dtc = vehicle_sim.step(s);
+        });
+        if (new_dtc) {
+            uint8_t code[2];
+            encodeDtc(new_dtc, code);
+            logEvent(EVT_DTC_ADDED, LOG_NO_ECU, (code[0] << 8) | code[1]);
+        }
+    }
+
+    if (!trace_running && !model_running) {
+        sim_deadline = 0;
+        return;
+    }
+    // Фіксований крок; після затримки (наприклад, зупинки процесу) не доганяємо
+    sim_deadline += SIM_STEP_US;
+    const uint64_t now = monotonicUs();
+    if (sim_deadline <= now) sim_deadline = now + SIM_STEP_US;
+}
+
+// Змінює стан автомобіля та перекодовує кеш відповідей усіх ECU.
+template <typename Fn>
+void updateVehicleState(Fn modify) {
+    modify(state);
+    state.version++;
+    for (ObdEcu &ecu : ecus) {
+        ecu.rebuildCache(state);
+    }
+    ui_refresh_pending = true;
+}
+
+void logEvent(LogEventType type, uint8_t ecu, uint32_t value,
+              uint8_t service, uint8_t pid, uint8_t count, uint16_t length) {
+    if (!event_log.enabled(type)) return;
+    LogEvent event = {};
+    event.timestamp_us = obd_hal.micros();
+    event.value = value;
+    event.length = length;
+    event.type = type;
+    event.ecu = ecu;
+    event.service = service;
+    event.pid = pid;
+    event.count = count;
+    event_log.push(event);
+}
+
+void drainLog() {
+    char line[128];
+    uint32_t dropped = event_log.takeDropped();
+    if (dropped > 0) {
+        printf("[log] %lu events dropped\n", (unsigned long)dropped);
+    }
+    LogEvent event;
+    while (event_log.pop(event)) {
+        const char *ecu_name = event.ecu < NUM_ECUS ? ecus[event.ecu].config.name : nullptr;
+        formatLogEvent(event, ecu_name, line, sizeof(line));
+        puts(line);
+    }
+}
+
+void setupWebServer(const char *web_root) {
+    // Стиснуті файли читаються один раз: data/ змінюється лише при перезбиранні
+    for (size_t i = 0; i < NUM_WEB_ASSETS; i++) {
+        const WebAsset &asset = WEB_ASSETS[i];
+        std::string body;
+        char etag[WEB_ETAG_SIZE] = "";
+        const std::string path = std::string(web_root) + asset.path + ".gz";
+        if (FILE *file = fopen(path.c_str(), "rb")) {
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0) body.append(buf, n);
+            fclose(file);
+            formatWebEtag(webAssetHash((const uint8_t *)body.data(), body.size()), body.size(), etag);
+        } else {
+            fprintf(stderr, "Web asset %s not found (run scripts/build_web.py or pass --web-root)\n", path.c_str());
+        }
+
+        http.on(asset.url, [&asset, body, etag = std::string(etag)](const HttpRequest &request, HttpResponse &response) {
+            if (etag.empty()) {
+                response.status = 503;
+                response.body = "Web UI is not built: run scripts/build_web.py";
+                return;
+            }
+            response.headers.emplace_back("ETag", etag);
+            response.headers.emplace_back("Cache-Control", WEB_CACHE_CONTROL);
+            if (webEtagMatches(request.header("if-none-match"), etag.c_str())) {
+                response.status = 304;
+                return;
+            }
+            response.content_type = asset.content_type;
+            response.headers.emplace_back("Content-Encoding", "gzip");
+            response.body = body;
+        });
+    }
+
+    http.on("/update", [](const HttpRequest &request, HttpResponse &response) {
+        updateVehicleState([&](VehicleState &s) {
+            applyStateUpdate(s, HttpRequestParams(request));
+        });
+        logEvent(EVT_STATE_UPDATED, LOG_NO_ECU, state.version, 0, 0, state.num_dtcs);
+        response.body = "Emulator data updated successfully!";
+    });
+
+    http.on("/clear_dtc", [](const HttpRequest &, HttpResponse &response) {
+        updateVehicleState([](VehicleState &s) { clearCurrentDtcs(s); });
+        logEvent(EVT_DTCS_CLEARED, 0);
+        response.body = "All DTCs cleared successfully!";
+    });
+
+    http.on("/cycle", [](const HttpRequest &, HttpResponse &response) {
+        bool permanent_cleared = false;
+        updateVehicleState([&](VehicleState &s) { permanent_cleared = applyDrivingCycle(s); });
+        logEvent(EVT_DRIVING_CYCLE, LOG_NO_ECU, state.error_free_cycles, 0, 0, permanent_cleared);
+        response.body = "Driving cycle simulated.";
+    });
+
+    http.on("/log", [](const HttpRequest &request, HttpResponse &response) {
+        if (const char *level = request.param("level")) {
+            int value = atoi(level);
+            event_log.setLevel((LogLevel)(value < LOG_OFF ? LOG_OFF : value > LOG_DEBUG ? LOG_DEBUG : value));
+        }
+        response.body = "Log level: " + std::to_string(event_log.level());
+    });
+
+    http.on("/trace", [](const HttpRequest &request, HttpResponse &response) {
+        if (request.param("stop")) {
+            stopTrace();
+            response.body = "Trace stopped.";
+            return;
+        }
+        const char *file = request.param("file");
+        const char *speed = request.param("speed");
+        const char *loop = request.param("loop");
+        if (!file || !startTrace(file, speed ? atof(speed) : 1.0f, !loop || strcmp(loop, "0") != 0)) {
+            response.status = 400;
+            response.body = file ? "Bad trace file" : "Missing 'file' parameter";
+            return;
+        }
+        response.body = "Trace started.";
+    });
+
+    http.on("/can_stats", [](const HttpRequest &, HttpResponse &response) {
+        response.content_type = "application/json";
+        response.body = getCanStatsJson();
+    });
+
+    // Новому клієнту - поточний стан; не вліз у чергу - ключовий кадр надішле notifyClients()
+    http.onWsConnect([](int client) {
+        if (!http.text(client, getJsonState())) ws_keyframe_clients.insert(client);
+        ui_refresh_pending = true; // Заводить періодичний ключовий кадр
+    });
+    http.onWsDisconnect([](int client) {
+        ws_binary_clients.erase(client);
+        ws_keyframe_clients.erase(client);
+    });
+    // Формат оновлень: "bin" - бінарні кадри (telemetry.h), "json" - текст
+    http.onWsMessage([](int client, const std::string &message) {
+        if (message == "bin") {
+            ws_binary_clients.insert(client);
+            ws_keyframe_clients.erase(client);
+            uint8_t frame[TELEMETRY_FRAME_SIZE];
+            encodeTelemetry(state, frame);
+            http.binary(client, frame, sizeof(frame));
+        } else if (message == "json") {
+            ws_binary_clients.erase(client);
+            ws_keyframe_clients.erase(client);
+            if (!http.text(client, getJsonState())) ws_keyframe_clients.insert(client);
+        }
+    });
+}
+
+// Кожен формат кодується не більше одного разу за оновлення. JSON-клієнтам - лише
+// змінені поля; ключовий кадр - раз на WS_KEYFRAME_INTERVAL_US та клієнтам, яким
+// відкинуто повідомлення (вони пропустили дельту). Бінарні кадри - повні, їх втрата не шкодить.
+void notifyClients() {
+    const uint64_t now = monotonicUs();
+    const bool periodic_keyframe = now - last_keyframe_us >= WS_KEYFRAME_INTERVAL_US;
+    if (periodic_keyframe) last_keyframe_us = now;
+
+    char buffer[STATE_JSON_MAX];
+    const std::string delta(buffer, writeStateJson(state, &ws_json_sent, buffer, sizeof(buffer)));
+    ws_json_sent = state;
+    std::string keyframe;
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    bool frame_ready = false;
+    bool json_clients = false;
+    for (int client : http.wsClients()) {
+        if (ws_binary_clients.count(client)) {
+            if (!frame_ready) {
+                encodeTelemetry(state, frame);
+                frame_ready = true;
+            }
+            http.binary(client, frame, sizeof(frame));
+            continue;
+        }
+        json_clients = true;
+        if (periodic_keyframe || ws_keyframe_clients.count(client)) {
+            if (keyframe.empty()) keyframe = getJsonState();
+            if (http.text(client, keyframe)) ws_keyframe_clients.erase(client);
+            else ws_keyframe_clients.insert(client);
+        } else if (!delta.empty() && !http.text(client, delta)) {
+            ws_keyframe_clients.insert(client);
+        }
+    }
+
+    // Ключові кадри мають іти й тоді, коли стан не змінюється
+    keyframe_deadline = 0;
+    if (json_clients) keyframe_deadline = last_keyframe_us + WS_KEYFRAME_INTERVAL_US;
+    if (!ws_keyframe_clients.empty()) keyframe_deadline = now + WS_RESYNC_INTERVAL_US;
+    rearmTimer();
+}
+
+// Ключовий кадр - усі поля
+std::string getJsonState() {
+    char json[STATE_JSON_MAX];
+    return std::string(json, writeStateJson(state, nullptr, json, sizeof(json)));
+}
+
+std::string getCanStatsJson() {
+    const TxQueue::Stats &queue = tx_queue.stats();
+    char json[320];
+    snprintf(json, sizeof(json),
+             "{\"rx\":%llu,\"tx_direct\":%llu,\"tx_queued\":%lu,\"tx_pending\":%zu,"
+             "\"tx_dropped_full\":%lu,\"tx_evicted\":%lu,\"tx_expired\":%lu,\"tx_failed\":%llu}",
+             (unsigned long long)can_counters.rx, (unsigned long long)can_counters.tx_direct,
+             (unsigned long)queue.queued, tx_queue.size(), (unsigned long)queue.dropped_full,
+             (unsigned long)queue.evicted, (unsigned long)queue.expired,
+             (unsigned long long)can_counters.tx_failed);
+    return json;
+}
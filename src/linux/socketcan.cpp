@@ -0,0 +1,88 @@
+#include "socketcan.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+bool SocketCan::open(const char *iface) {
+    close();
+    unsigned int index = if_nametoindex(iface);
+    if (index == 0) return false;
+
+    fd_ = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd_ < 0) return false;
+
+    sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = index;
+    if (bind(fd_, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        int saved = errno;
+        close();
+        errno = saved;
+        return false;
+    }
+    return true;
+}
+
+void SocketCan::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+bool SocketCan::setFilter(const uint32_t *ids, size_t count) {
+    if (count == 0) {
+        can_filter all = {0, 0};
+        return setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FILTER, &all, sizeof(all)) == 0;
+    }
+    std::vector<can_filter> filters(count);
+    for (size_t i = 0; i < count; i++) {
+        if (isExtendedCanId(ids[i])) {
+            filters[i].can_id = rawCanId(ids[i]) | CAN_EFF_FLAG;
+            filters[i].can_mask = CAN_EFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+        } else {
+            filters[i].can_id = rawCanId(ids[i]);
+            filters[i].can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+        }
+    }
+    return setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                      filters.size() * sizeof(can_filter)) == 0;
+}
+
+SocketCan::Result SocketCan::read(CanFrame &frame) {
+    for (;;) {
+        can_frame raw;
+        ssize_t n = ::read(fd_, &raw, sizeof(raw));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? WOULD_BLOCK : FAILED;
+        }
+        if (n != sizeof(raw)) continue; // CAN FD кадри не підтримуються
+        if (raw.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) continue;
+
+        frame = {};
+        frame.id = (raw.can_id & CAN_EFF_FLAG) ? ((raw.can_id & CAN_EFF_MASK) | CAN_EXTENDED_FLAG)
+                                                : (raw.can_id & CAN_SFF_MASK);
+        frame.dlc = raw.can_dlc > CAN_MAX_DLC ? CAN_MAX_DLC : raw.can_dlc;
+        memcpy(frame.data, raw.data, frame.dlc);
+        return OK;
+    }
+}
+
+SocketCan::Result SocketCan::write(const CanFrame &frame) {
+    can_frame raw = {};
+    raw.can_id = isExtendedCanId(frame.id) ? (rawCanId(frame.id) | CAN_EFF_FLAG) : rawCanId(frame.id);
+    raw.can_dlc = frame.dlc;
+    memcpy(raw.data, frame.data, CAN_MAX_DLC);
+    for (;;) {
+        if (::write(fd_, &raw, sizeof(raw)) == sizeof(raw)) return OK;
+        if (errno == EINTR) continue;
+        return (errno == ENOBUFS || errno == EAGAIN || errno == EWOULDBLOCK) ? WOULD_BLOCK : FAILED;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_frame.h"
+
+// ############## SocketCAN (Linux) ##############
+// Неблокувальний сокет CAN_RAW на vcan0, can0, slcan0 тощо. Кадри перетворюються
+// з/у CanFrame ядра OBD; CAN_EXTENDED_FLAG відповідає CAN_EFF_FLAG.
+class SocketCan {
+public:
+    enum Result { OK, WOULD_BLOCK, FAILED };
+
+    ~SocketCan() { close(); }
+
+    // false - інтерфейсу немає або він недоступний (причина в errno).
+    bool open(const char *iface);
+    void close();
+
+    // Ядро пропускає лише кадри даних з цими ID (точний збіг, з урахуванням формату).
+    // Порожній список - приймати все.
+    bool setFilter(const uint32_t *ids, size_t count);
+
+    // Пропускає RTR та кадри помилок. WOULD_BLOCK - прийнято все.
+    Result read(CanFrame &frame);
+
+    // WOULD_BLOCK - черга інтерфейсу заповнена (ENOBUFS), кадр варто повторити пізніше.
+    Result write(const CanFrame &frame);
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_ = -1;
+};
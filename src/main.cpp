@@ -1,14 +1,32 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
+#include <LittleFS.h>
 #include <driver/twai.h>
-
-#include "web_page.h"
+#include <esp_timer.h>
+#include <atomic>
+#include <memory>
+
+#include "web_assets.h"
+#include "obd_ecu.h"
+#include "service01_pids.h"
+#include "service06_monitors.h"
+#include "service09_info.h"
+#include "seqlock.h"
+#include "vehicle_state.h"
+#include "event_log.h"
+#include "tx_queue.h"
+#include "telemetry.h"
+#include "state_json.h"
+#include "trace_player.h"
+#include "can_recorder.h"
+#include "vehicle_sim.h"
 
 // --- TFT Display ---
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
 #include <SPI.h>
+#include "status_display.h"
 
 // ############## Налаштування пінів TFT ST7735 ##############
 // Якщо у вас інші піни, змініть їх тут
@@ -27,43 +45,113 @@
 
 Adafruit_ST7735 tft = Adafruit_ST7735(TFT_CS, TFT_DC, TFT_RST);
 
+// Після старту панеллю володіє лише задача дисплея: рендер у буфер кадру і передача
+// по SPI не займають час loop(), веб-обробників чи CAN. Інші задачі лише просять
+// оновлення (requestDisplayUpdate); кілька запитів до його виконання зливаються в один.
+StatusDisplay status_display(tft);
+const UBaseType_t DISPLAY_TASK_PRIORITY = 1;
+const uint32_t DISPLAY_TASK_STACK = 4096;
+TaskHandle_t displayTaskHandle = NULL;
+
 // ############## Налаштування CAN ##############
 const int CAN_TX_PIN = 20;
 const int CAN_RX_PIN = 21;
-char vin[18] = "VIN_NOT_SET";
-char cal_id[17] = "EMULATOR_CAL_ID";
-char cvn[9] = "A1B2C3D4";
-char dtcs[5][6] = {"", "", "", "", ""};
-int num_dtcs = 0;
-char permanent_dtcs[5][6] = {"", "", "", "", ""};
-int num_permanent_dtcs = 0;
-int engine_rpm = 1500;
-int engine_temp = 90;
-int vehicle_speed = 60; // km/h
-float maf_rate = 10.0; // g/s
-bool dynamic_rpm_enabled = false;
-bool misfire_simulation_enabled = false;
-bool lean_mixture_simulation_enabled = false;
-float timing_advance = 5.0; // degrees
-float fuel_rate = 1.5; // L/h
-int fuel_pressure = 350; // kPa (Normal ~300-400)
-float fuel_level = 75.0; // %
-int distance_with_mil = 0; // km
-float battery_voltage = 14.2; // V
-int error_free_cycles = 0;
-const int CYCLES_THRESHOLD = 3; // Кількість циклів для очищення Permanent DTC
-
-// --- ISO-TP State Machine ---
-enum IsoTpState {
-    ISOTP_IDLE,
-    ISOTP_SEND_VIN_CF1,
-    ISOTP_SEND_VIN_CF2,
-    ISOTP_SEND_CALID_CF1,
-    ISOTP_SEND_CALID_CF2
+
+// CAN обробляється окремою задачею на іншому ядрі, ніж loop() (веб, дисплей, симуляція),
+// з пріоритетом вище за Wi-Fi - відповідь не чекає на перемальовування TFT чи WebSocket.
+const BaseType_t CAN_TASK_CORE = ARDUINO_RUNNING_CORE == 0 ? 1 : 0;
+const UBaseType_t CAN_TASK_PRIORITY = configMAX_PRIORITIES - 1;
+const uint32_t CAN_TASK_STACK = 4096;
+const uint32_t CAN_RX_QUEUE_LEN = 32;
+const uint32_t CAN_TX_QUEUE_LEN = 16;
+TaskHandle_t canTaskHandle = NULL;
+
+// ############## Передача CAN ##############
+// Ніхто не чекає на twai_transmit(): кадр іде в TX-чергу драйвера без очікування,
+// а якщо вона заповнена або шина в bus-off - у програмну чергу (tx_queue.h),
+// яку CAN-задача доливає в драйвер за TWAI-алертами. Без тестера на шині (немає ACK)
+// чи в bus-off кадри просто старіють і відкидаються, а не блокують веб чи дисплей.
+const uint32_t TX_DEADLINE_US = 50000;       // P2CAN: пізніша відповідь тестеру вже не потрібна
+const uint32_t TX_STALL_TIMEOUT_US = 200000; // Драйвер не передав жодного кадру - скидаємо контролер
+const TickType_t CAN_POLL_TICKS = pdMS_TO_TICKS(10); // Перевірка дедлайнів і зависання без алертів
+const uint32_t CAN_ALERTS = TWAI_ALERT_RX_DATA | TWAI_ALERT_RX_QUEUE_FULL |
+                            TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE |
+                            TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_ERR_PASS;
+
+TxQueue tx_queue;                 // Під txMutex
+SemaphoreHandle_t txMutex;
+std::atomic<bool> can_bus_running(false);
+std::atomic<uint32_t> tx_last_progress_us(0);
+
+struct CanBusCounters {
+    std::atomic<uint32_t> tx_direct{0};    // Одразу в чергу драйвера
+    std::atomic<uint32_t> bus_off{0};
+    std::atomic<uint32_t> recoveries{0};
+    std::atomic<uint32_t> stall_resets{0};
+    std::atomic<uint32_t> error_passive{0};
+};
+CanBusCounters can_counters;
+
+// Listen-only (/can_mode?listen=1): контролер лише слухає шину - без ACK і передачі,
+// ECU мовчать, апаратний фільтр пропускає всі кадри. Так видно, що й як часто
+// опитує справжній сканер у справжньому авто. Драйвер перевстановлює CAN-задача.
+std::atomic<bool> can_listen_only(false);           // Поточний режим драйвера
+std::atomic<bool> can_listen_only_requested(false);
+
+// ############## Запис CAN-трафіку ##############
+// /record?start - почати запис (попередній файл перезаписується), /record?stop - зупинити,
+// /record - стан (JSON), /record.log - завантажити у форматі `candump -l` (can_recorder.h).
+// Кадри з мітками esp_timer_get_time() йдуть у кільцевий буфер без блокувань,
+// задача запису скидає їх у LittleFS. Мітка RX - момент вичитування з черги драйвера,
+// TX - передачі кадру в драйвер.
+const char *const RECORD_PATH = "/can_record.bin";
+const char *const RECORD_IFACE = "can0";
+const size_t RECORD_MAX_BYTES = 512 * 1024;  // ~21800 кадрів
+const size_t RECORD_FS_RESERVE = 64 * 1024;  // Місце, яке запис лишає вільним у LittleFS
+const uint32_t RECORD_FLUSH_PERIOD_MS = 50;
+const int RECORD_BATCH = 32;                 // Записів за один write()
+const UBaseType_t RECORD_TASK_PRIORITY = 1;
+const uint32_t RECORD_TASK_STACK = 4096;
+TaskHandle_t recordTaskHandle = NULL;
+
+CanRecorder can_recorder;
+std::atomic<bool> record_requested(false); // Веб-обробник -> задача запису
+std::atomic<bool> record_file_open(false); // Файл пише задача - завантаження недоступне
+std::atomic<uint32_t> record_frames(0);
+std::atomic<uint32_t> record_dropped(0);
+
+// ############## Стан автомобіля ##############
+// Опублікований знімок читається без блокувань (CAN-задача, дисплей, веб).
+// Зміни - лише через updateVehicleState(), яка серіалізує записувачів,
+// публікує нову версію та перебудовує кеш CAN-відповідей.
+SeqLock<VehicleState> vehicle;
+SemaphoreHandle_t stateWriteMutex;
+
+// ############## Журнал подій ##############
+// Записи з CAN-шляху виводить низькопріоритетна задача (див. event_log.h).
+// Рівень змінюється під час роботи: /log?level=0..3 (OFF, ERROR, INFO, DEBUG).
+EventLog event_log;
+const UBaseType_t LOG_TASK_PRIORITY = 1;
+const uint32_t LOG_TASK_STACK = 3072;
+const uint32_t LOG_DRAIN_PERIOD_MS = 50;
+const int LOG_DRAIN_BUDGET = 8; // Рядків за період: ~115200 бод не встигають більше
+TaskHandle_t logTaskHandle = NULL;
+
+// Запит на оновлення дисплея та веб-клієнтів з інших задач (CAN, веб-обробники).
+// Веб-клієнтів оновлює loop(), дисплей - власна задача, тож CAN-шлях не блокується.
+std::atomic<bool> ui_refresh_pending(false);
+
+// ############## Віртуальні ECU ##############
+// Протокол (сервіси OBD, ISO-TP, кеш відповідей) - у lib/obd_core і не залежить від ESP-IDF.
+// Тут лише платформа: м'ютекс та esp_timer кожного ECU, передача через TWAI (Esp32ObdHal).
+const int NUM_ECUS = 2;
+extern ObdEcu ecus[NUM_ECUS]; // ecus[0] - ECM, його DTC показує веб-інтерфейс
+
+struct EcuPlatform {
+    SemaphoreHandle_t mutex;              // send/FC/таймери викликаються з різних задач
+    esp_timer_handle_t timers[2];         // Індекс - ObdTimer
 };
-IsoTpState isoTpState = ISOTP_IDLE;
-unsigned long isoTpNextTime = 0;
-const int ISOTP_DELAY_MS = 5; // STmin simulation
+EcuPlatform ecu_platform[NUM_ECUS];
 
 // ############## Налаштування Wi-Fi та веб-сервера ##############
 const char* ap_ssid = "OBD-II-Emulator-A";
@@ -71,22 +159,120 @@ const char* ap_password = "123456789";
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
+// ETag файлів веб-інтерфейсу (web_assets.h); порожній - файлу немає в LittleFS
+char web_asset_etags[NUM_WEB_ASSETS][WEB_ETAG_SIZE];
+
+// Формат обирає клієнт повідомленням після підключення: "bin" - бінарна телеметрія
+// (telemetry.h) з частотою до 20 Гц, "json" - текст, як раніше, раз на 500 мс.
+// JSON-клієнти отримують ключовий кадр (усі поля) після підключення та раз на
+// WS_KEYFRAME_INTERVAL_MS, між ними - лише змінені поля (state_json.h).
+// Таблицю змінюють події WebSocket (задача AsyncTCP), читає notifyClients().
+const unsigned long WS_JSON_INTERVAL_MS = 500;
+const unsigned long WS_BINARY_INTERVAL_MS = 50;
+const unsigned long WS_KEYFRAME_INTERVAL_MS = 10000; // Відновлює клієнтів, що загубили дельту
+const int MAX_WS_CLIENTS = 8; // DEFAULT_MAX_WS_CLIENTS у ESPAsyncWebServer
+
+enum WsFormat : uint8_t {
+    WS_FORMAT_JSON = 1 << 0,
+    WS_FORMAT_BINARY = 1 << 1,
+    WS_FORMAT_ALL = WS_FORMAT_JSON | WS_FORMAT_BINARY,
+};
+
+struct WsClientSlot {
+    std::atomic<uint32_t> id{0}; // 0 - вільно
+    std::atomic<bool> binary{false};
+    std::atomic<bool> keyframe{false}; // Наступне JSON-повідомлення - ключовий кадр
+};
+WsClientSlot ws_clients[MAX_WS_CLIENTS];
+
+// ############## Відтворення трас ##############
+// CSV-траса з LittleFS (trace_player.h) замінює модель dynamic_rpm, доки грає.
+// Запускає /trace?file=/city.csv[&speed=2][&loop=0], зупиняє /trace?stop.
+// Позицію рахує задача симуляції від esp_timer_get_time(): читання flash - поза
+// esp_timer і поза stateWriteMutex, під м'ютексом стан лише отримує готові значення.
+class LittleFsTraceReader : public TraceReader {
+public:
+    bool open(const String &path) {
+        close();
+        file_ = LittleFS.open(path, "r");
+        return (bool)file_;
+    }
+    void close() {
+        if (file_) file_.close();
+    }
+    bool readLine(char *buf, size_t size) override {
+        if (!file_.available()) return false;
+        size_t len = file_.readBytesUntil('\n', buf, size - 1);
+        if (len > 0 && buf[len - 1] == '\r') len--;
+        buf[len] = '\0';
+        return true;
+    }
+    bool rewind() override { return file_ && file_.seek(0); }
+
+private:
+    File file_;
+};
+
+LittleFsTraceReader trace_reader; // Обидва - під traceMutex
+TracePlayer trace_player;
+SemaphoreHandle_t traceMutex;
+
+// ############## Симуляція ##############
+// Власна задача з фіксованим кроком VehicleSim::STEP_MS (100 Гц) незалежно від loop():
+// траса або модель руху (vehicle_sim.h), коли ввімкнено dynamic_rpm. loop() лише
+// розсилає результат веб-клієнтам з власною частотою, поки simulation_running.
+const TickType_t SIM_PERIOD_TICKS = pdMS_TO_TICKS(VehicleSim::STEP_MS);
+const UBaseType_t SIM_TASK_PRIORITY = 2; // Вище за журнал і дисплей, нижче за CAN
+const uint32_t SIM_TASK_STACK = 4096;
+TaskHandle_t simTaskHandle = NULL;
+VehicleSim vehicle_sim; // Лише задача симуляції
+std::atomic<bool> simulation_running(false);
+
+// Параметри веб-запиту /update для applyStateUpdate()
+class WebRequestParams : public StateParams {
+public:
+    explicit WebRequestParams(AsyncWebServerRequest *request) : request_(request) {}
+    const char *get(const char *name) const override {
+        return request_->hasParam(name) ? request_->getParam(name)->value().c_str() : nullptr;
+    }
+
+private:
+    AsyncWebServerRequest *request_;
+};
+
 // ############## Прототипи функцій ##############
-void handleOBDRequest(const twai_message_t &frame);
-void sendVIN(byte pid);
-void sendCalId(byte pid);
-void sendCvn(byte pid);
-void sendSupportedPids_09(byte pid);
-void processIsoTp();
-void sendDTCs();
-void sendPermanentDTCs();
-void clearDTCs();
-void sendCurrentData(byte pid);
-void updateDisplay();
-void notifyClients();
+void setupEcus();
+void setupWebAssets();
+void serveWebAsset(AsyncWebServerRequest *request, size_t index);
+void canTask(void *arg);
+bool startTwai(bool listen_only);
+void stopTwai();
+bool canTransmit(const CanFrame &frame, uint8_t priority);
+twai_message_t toTwaiMessage(const CanFrame &frame);
+CanFrame fromTwaiMessage(const twai_message_t &message);
+void pumpTxQueue();
+void handleBusAlerts(uint32_t alerts);
+String getCanStatsJson();
+void recordTask(void *arg);
+String getRecordStatusJson();
+void sendRecording(AsyncWebServerRequest *request);
+void logTask(void *arg);
+void logEvent(LogEventType type, uint8_t ecu = LOG_NO_ECU, uint32_t value = 0,
+              uint8_t service = 0, uint8_t pid = 0, uint8_t count = 0, uint16_t length = 0);
+void refreshResponseCache(const VehicleState &s);
+template <typename Fn> void updateVehicleState(Fn modify);
+void requestUiRefresh();
+void clearStoredDtcs();
+void displayTask(void *arg);
+void requestDisplayUpdate();
+void notifyClients(uint8_t formats = WS_FORMAT_ALL);
+WsClientSlot *findWsClient(uint32_t id);
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
-bool addDTC(const char* new_dtc);
 void completeDrivingCycle();
+String startTrace(AsyncWebServerRequest *request);
+void simTask(void *arg);
+bool stepTrace();
+void stepSimulation(bool restart);
 
 
 void setup() {
@@ -116,156 +302,73 @@ void setup() {
   tft.println(IP);
 
   // --- Налаштування CAN ---
-  twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)CAN_TX_PIN, (gpio_num_t)CAN_RX_PIN, TWAI_MODE_NORMAL);
-  twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
-  // Accept all messages, we will filter by ID in the code
-  twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+  // Драйвер TWAI встановлюється всередині CAN-задачі, щоб його переривання
+  // обслуговувалось тим самим ядром.
+  txMutex = xSemaphoreCreateMutex();
+  traceMutex = xSemaphoreCreateMutex();
+  setupEcus();
+  xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &logTaskHandle, ARDUINO_RUNNING_CORE);
+  xTaskCreatePinnedToCore(recordTask, "record", RECORD_TASK_STACK, NULL, RECORD_TASK_PRIORITY, &recordTaskHandle, ARDUINO_RUNNING_CORE);
+  xTaskCreatePinnedToCore(canTask, "can", CAN_TASK_STACK, NULL, CAN_TASK_PRIORITY, &canTaskHandle, CAN_TASK_CORE);
 
-  // Install and start TWAI driver
-  if (twai_driver_install(&g_config, &t_config, &f_config) != ESP_OK) {
-      Serial.println("Failed to install TWAI driver");
-      return;
-  }
-  if (twai_start() != ESP_OK) {
-      Serial.println("Failed to start TWAI driver");
-      return;
+  // --- Налаштування веб-сервера ---
+  setupWebAssets();
+  for (size_t i = 0; i < NUM_WEB_ASSETS; i++) {
+    server.on(WEB_ASSETS[i].url, HTTP_GET, [i](AsyncWebServerRequest *request) {
+      serveWebAsset(request, i);
+    });
   }
-  Serial.println("TWAI (CAN) bus initialized.");
 
-  // --- Налаштування веб-сервера ---
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(200, "text/html", index_html);
+  server.on("/update", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    // Усі зміни застосовуються до робочої копії й публікуються разом,
+    // тож CAN-відповідь ніколи не побачить, наприклад, обнулений num_dtcs.
+    updateVehicleState([&](VehicleState &s) {
+      applyStateUpdate(s, WebRequestParams(request));
+    });
+
+    const VehicleState s = vehicle.read();
+    logEvent(EVT_STATE_UPDATED, LOG_NO_ECU, s.version, 0, 0, s.num_dtcs);
+    
+    requestUiRefresh(); // Екран і веб-клієнти оновить loop()
+
+    request->send(200, "text/plain", "Emulator data updated successfully!");
   });
 
-  server.on("/update", HTTP_GET, [] (AsyncWebServerRequest *request) {
-    if(request->hasParam("vin")) strncpy(vin, request->getParam("vin")->value().c_str(), 17);
-    if(request->hasParam("cal_id")) strncpy(cal_id, request->getParam("cal_id")->value().c_str(), 16);
-    if(request->hasParam("cvn")) strncpy(cvn, request->getParam("cvn")->value().c_str(), 8);
-
-    // Скидаємо старі DTC
-    num_dtcs = 0;
-    num_permanent_dtcs = 0;
-    for(int i=0; i<5; i++) {
-        dtcs[i][0] = '\0';
-        permanent_dtcs[i][0] = '\0';
-    }
-
-    // Якщо прийшов параметр dtc_list (кома-розділений список), використаємо його (переважно)
-    if(request->hasParam("dtc_list")){
-      String list = request->getParam("dtc_list")->value();
-      int start = 0;
-      while(num_dtcs < 5){
-        int comma = list.indexOf(',', start);
-        String token;
-        if(comma == -1){
-          token = list.substring(start);
-        } else {
-          token = list.substring(start, comma);
-        }
-        token.trim();
-        if(token.length() == 5){
-          // При оновленні з веб-форми, заповнюємо обидва списки однаково
-          strncpy(dtcs[num_dtcs], token.c_str(), 5);
-          dtcs[num_dtcs][5] = '\0';
-          strncpy(permanent_dtcs[num_dtcs], token.c_str(), 5);
-          permanent_dtcs[num_dtcs][5] = '\0';
-          num_dtcs++;
-        }
-        if(comma == -1) break;
-        start = comma + 1;
-      }
-    } else {
-      // Збираємо нові DTC з частин (зворотна сумісність зі старою формою)
-      for (int i=1; i<=5; i++){
-        String dtc_sys_param = "dtc" + String(i) + "_sys";
-        String dtc_type_param = "dtc" + String(i) + "_type";
-        String dtc_code_param = "dtc" + String(i) + "_code";
-
-        if(request->hasParam(dtc_code_param) && request->getParam(dtc_code_param)->value().length() > 0) {
-          String dtc_full = request->getParam(dtc_sys_param)->value() +
-                            request->getParam(dtc_type_param)->value() +
-                            request->getParam(dtc_code_param)->value();
-
-          if(dtc_full.length() >= 4){
-            // Normalize: pad numeric part to 3 digits if necessary
-            // Expecting total length 5 (e.g., P0123)
-            if(dtc_full.length() < 5){
-              // if code part shorter, pad with leading zeros
-              char buf[8];
-              strncpy(buf, dtc_full.c_str(), sizeof(buf)-1);
-              buf[sizeof(buf)-1] = '\0';
-              // ensure we only copy 5 chars into dtcs
-              strncpy(dtcs[num_dtcs], buf, 5);
-              dtcs[num_dtcs][5] = '\0';
-            } else {
-              strncpy(dtcs[num_dtcs], dtc_full.c_str(), 5);
-              dtcs[num_dtcs][5] = '\0';
-            }
-            num_dtcs++;
-          }
-        }
-      }
-    }
-    num_permanent_dtcs = num_dtcs; // Синхронізуємо лічильники
+  server.on("/clear_dtc", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    clearStoredDtcs(); // Те саме, що сервіс 04 для ECM, але без CAN-відповіді (запиту не було)
+    logEvent(EVT_DTCS_CLEARED, 0);
+    request->send(200, "text/plain", "All DTCs cleared successfully!");
+  });
 
-    if(request->hasParam("temp")) engine_temp = request->getParam("temp")->value().toInt();
-    if(request->hasParam("rpm")) engine_rpm = request->getParam("rpm")->value().toInt();
-    if(request->hasParam("speed")) vehicle_speed = request->getParam("speed")->value().toInt();
-    if(request->hasParam("maf")) maf_rate = request->getParam("maf")->value().toFloat();
-    if(request->hasParam("timing")) timing_advance = request->getParam("timing")->value().toFloat();
-    if(request->hasParam("fuel_rate")) fuel_rate = request->getParam("fuel_rate")->value().toFloat();
-    if(request->hasParam("fuel_pressure")) fuel_pressure = request->getParam("fuel_pressure")->value().toInt();
-    
-    if(request->hasParam("fuel")) fuel_level = request->getParam("fuel")->value().toFloat();
-    if(request->hasParam("dist_mil")) distance_with_mil = request->getParam("dist_mil")->value().toInt();
-    if(request->hasParam("voltage")) battery_voltage = request->getParam("voltage")->value().toFloat();
-    
-    if(request->hasParam("dynamic_rpm")) {
-        String val = request->getParam("dynamic_rpm")->value();
-        dynamic_rpm_enabled = (val == "true" || val == "1" || val == "on");
+  server.on("/log", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    if (request->hasParam("level")) {
+      event_log.setLevel((LogLevel)constrain(request->getParam("level")->value().toInt(), LOG_OFF, LOG_DEBUG));
     }
+    request->send(200, "text/plain", "Log level: " + String(event_log.level()));
+  });
 
-    if(request->hasParam("misfire_sim")) {
-        String val = request->getParam("misfire_sim")->value();
-        misfire_simulation_enabled = (val == "true" || val == "1" || val == "on");
-    }
+  server.on("/can_stats", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    request->send(200, "application/json", getCanStatsJson());
+  });
 
-    if(request->hasParam("lean_mixture_sim")) {
-        String val = request->getParam("lean_mixture_sim")->value();
-        lean_mixture_simulation_enabled = (val == "true" || val == "1" || val == "on");
+  server.on("/can_mode", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    if (request->hasParam("listen")) {
+      can_listen_only_requested.store(request->getParam("listen")->value() != "0"); // Перемкне CAN-задача
     }
-    
-    Serial.println("========== Emulator Data Updated ==========");
-    Serial.println("VIN: " + String(vin));
-    Serial.println("CAL ID: " + String(cal_id));
-    Serial.println("CVN: " + String(cvn));
-    for(int i=0; i<num_dtcs; i++){
-      Serial.println("DTC "+ String(i+1) +": " + String(dtcs[i]));
-    }
-    Serial.println("Engine Temp: " + String(engine_temp));
-    Serial.println("Engine RPM: " + String(engine_rpm));
-    Serial.println("Vehicle Speed: " + String(vehicle_speed) + " km/h");
-    Serial.println("MAF Rate: " + String(maf_rate) + " g/s");
-    Serial.println("Timing Adv: " + String(timing_advance) + " deg");
-    Serial.println("Fuel Rate: " + String(fuel_rate) + " L/h");
-    Serial.println("Fuel Press: " + String(fuel_pressure) + " kPa");
-    Serial.println("Dynamic RPM: " + String(dynamic_rpm_enabled ? "ON" : "OFF"));
-    Serial.println("Misfire Sim: " + String(misfire_simulation_enabled ? "ON" : "OFF"));
-    Serial.println("Lean Sim: " + String(lean_mixture_simulation_enabled ? "ON" : "OFF"));
-    Serial.println("Fuel Level: " + String(fuel_level) + " %");
-    Serial.println("Distance with MIL: " + String(distance_with_mil) + " km");
-    Serial.println("Battery Voltage: " + String(battery_voltage) + " V");
-    Serial.println("==========================================");
-    
-    updateDisplay(); // Оновлюємо екран
-    notifyClients(); // Повідомляємо веб-клієнтів про зміни
+    request->send(200, "text/plain", String("Listen-only: ") + (can_listen_only_requested.load() ? "on" : "off"));
+  });
 
-    request->send(200, "text/plain", "Emulator data updated successfully!");
+  server.on("/record", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    if (request->hasParam("start")) {
+      record_requested.store(true);
+    } else if (request->hasParam("stop")) {
+      record_requested.store(false);
+    }
+    request->send(200, "application/json", getRecordStatusJson());
   });
 
-  server.on("/clear_dtc", HTTP_GET, [] (AsyncWebServerRequest *request) {
-    clearDTCs(); // Ця функція вже надсилає CAN-відповідь та оновлює дисплей
-    request->send(200, "text/plain", "All DTCs cleared successfully!");
+  server.on("/record.log", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    sendRecording(request);
   });
 
   server.on("/cycle", HTTP_GET, [] (AsyncWebServerRequest *request) {
@@ -273,183 +376,714 @@ void setup() {
     request->send(200, "text/plain", "Driving cycle simulated.");
   });
 
+  server.on("/trace", HTTP_GET, [] (AsyncWebServerRequest *request) {
+    String error = startTrace(request);
+    if (error.length() > 0) {
+      request->send(400, "text/plain", error);
+    } else {
+      request->send(200, "text/plain", request->hasParam("stop") ? "Trace stopped." : "Trace started.");
+    }
+  });
+
   ws.onEvent(onWsEvent);
   server.addHandler(&ws);
 
   server.begin();
   Serial.println("Web server started.");
   delay(1000); // Затримка, щоб побачити стартові повідомлення
-  updateDisplay(); // Перше оновлення екрану з початковими даними
+
+  // Далі панеллю володіє задача дисплея
+  if (!status_display.begin()) {
+    Serial.println("Display framebuffer allocation failed, TFT status disabled.");
+  }
+  xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_TASK_STACK, NULL, DISPLAY_TASK_PRIORITY, &displayTaskHandle, ARDUINO_RUNNING_CORE);
+  xTaskCreatePinnedToCore(simTask, "sim", SIM_TASK_STACK, NULL, SIM_TASK_PRIORITY, &simTaskHandle, ARDUINO_RUNNING_CORE);
+  requestDisplayUpdate(); // Перше оновлення екрану з початковими даними
 }
 
-void loop() {
-  twai_message_t rx_frame;
-  // Перевіряємо наявність вхідних CAN-повідомлень з невеликим таймаутом.
-  // Основна робота керується подіями від CAN або веб-сервера.
-  if (twai_receive(&rx_frame, pdMS_TO_TICKS(10)) == ESP_OK) {
-    // Відповідаємо тільки на загальні OBD-II запити (ID 0x7DF)
-    if (rx_frame.identifier == 0x7DF && !rx_frame.rtr) { // OBD_CAN_ID_REQUEST
-        handleOBDRequest(rx_frame);
-    }
+// Задача CAN: спить до TWAI-алерту і вичерпує RX-чергу драйвера.
+void canTask(void *arg) {
+  if (!startTwai(false)) {
+      vTaskDelete(NULL);
+      return;
   }
 
-  processIsoTp(); // Обробка черги ISO-TP (без delay)
-
-  // Емуляція динамічної зміни RPM (синусоїда)
-  if (dynamic_rpm_enabled) {
-      unsigned long now = millis();
-      // Синусоїда: Центр 2500, Амплітуда 1500 (від 1000 до 4000), Період ~5 секунд
-      engine_rpm = 2500 + 1500 * sin(2 * PI * now / 5000.0);
-      
-      // Динамічна зміна інших параметрів для демонстрації графіків
-      maf_rate = 5.0 + (engine_rpm / 100.0); // Приблизна залежність
-      fuel_rate = 0.5 + (engine_rpm / 1000.0); // Приблизна залежність
-      if (!lean_mixture_simulation_enabled) fuel_pressure = 350 + (engine_rpm / 50); // Нормальна робота
-
-      // Симуляція пробігу з помилкою
-      if (num_dtcs > 0) {
-          static unsigned long last_dist_update = 0;
-          if (now - last_dist_update > 5000) { // Додаємо 1 км кожні 5с для демонстрації
-              distance_with_mil++;
-              last_dist_update = now;
-          }
+  for (;;) {
+    const bool listen_only = can_listen_only_requested.load();
+    if (listen_only != can_listen_only.load()) {
+      stopTwai();
+      if (!startTwai(listen_only)) {
+        can_listen_only_requested.store(!listen_only); // Повертаємо попередній режим
+        if (!startTwai(!listen_only)) {
+          Serial.println("TWAI restart failed, CAN task stopped");
+          vTaskDelete(NULL);
+          return;
+        }
       }
+    }
+
+    uint32_t alerts = 0;
+    twai_read_alerts(&alerts, CAN_POLL_TICKS); // Таймаут - теж привід перевірити TX
+    handleBusAlerts(alerts);
 
-      if (misfire_simulation_enabled && engine_rpm > 3500) {
-          // Якщо додали новий DTC, одразу оновлюємо інтерфейси
-          if (addDTC("P0300")) {
-              notifyClients();
-              updateDisplay();
-          }
+    if (alerts & TWAI_ALERT_RX_QUEUE_FULL) {
+      logEvent(EVT_RX_QUEUE_FULL);
+    }
+    if (alerts & (TWAI_ALERT_RX_DATA | TWAI_ALERT_RX_QUEUE_FULL)) {
+      twai_message_t rx_message;
+      while (twai_receive(&rx_message, 0) == ESP_OK) {
+        const uint32_t rx_us = micros();
+        const CanFrame rx_frame = fromTwaiMessage(rx_message);
+        logEvent(EVT_CAN_RX, LOG_NO_ECU, rx_frame.id, 0, 0, 0, rx_frame.dlc);
+        can_recorder.record(rx_frame, esp_timer_get_time(), false);
+        // Функціональні (0x7DF) та фізичні (0x7E0..0x7E7) запити до віртуальних ECU.
+        // Точна перевірка ID - у dispatchObdFrame(): апаратний фільтр може пропускати зайве.
+        if (!rx_message.rtr && !can_listen_only.load()) {
+            dispatchObdFrame(ecus, NUM_ECUS, rx_frame, rx_us);
+        }
       }
+    }
+    pumpTxQueue();
+  }
+}
+
+// Встановлює і запускає драйвер TWAI. Лише CAN-задача.
+bool startTwai(bool listen_only) {
+  twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)CAN_TX_PIN, (gpio_num_t)CAN_RX_PIN,
+                                                               listen_only ? TWAI_MODE_LISTEN_ONLY : TWAI_MODE_NORMAL);
+  g_config.rx_queue_len = CAN_RX_QUEUE_LEN;
+  g_config.tx_queue_len = CAN_TX_QUEUE_LEN;
+  g_config.alerts_enabled = CAN_ALERTS;
+  twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
+  // Апаратний фільтр пропускає лише запити до віртуальних ECU (див. can_filter.h),
+  // тож сторонній трафік шини не заповнює RX-чергу і не будить задачу.
+  // У listen-only потрібен саме весь трафік.
+  twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+  const CanFilterPlan filter = planEcuFilter(ecus, NUM_ECUS);
+  if (!listen_only) {
+    f_config.acceptance_code = filter.config.acceptance_code;
+    f_config.acceptance_mask = filter.config.acceptance_mask;
+    f_config.single_filter = filter.config.single_filter;
+  }
+
+  // Install and start TWAI driver
+  if (twai_driver_install(&g_config, &t_config, &f_config) != ESP_OK) {
+      Serial.println("Failed to install TWAI driver");
+      return false;
+  }
+  if (twai_start() != ESP_OK) {
+      Serial.println("Failed to start TWAI driver");
+      twai_driver_uninstall();
+      return false;
+  }
+  can_listen_only.store(listen_only);
+  can_bus_running.store(true);
+  tx_last_progress_us.store(micros());
+  Serial.printf("TWAI (CAN) bus initialized%s, CAN task on core %d.\n",
+                listen_only ? " in listen-only mode" : "", (int)CAN_TASK_CORE);
+  if (!listen_only) {
+    Serial.printf("TWAI filter: %s, code 0x%08lX, mask 0x%08lX, %llu IDs pass (%s)\n",
+                  f_config.single_filter ? "single" : "dual",
+                  (unsigned long)f_config.acceptance_code, (unsigned long)f_config.acceptance_mask,
+                  (unsigned long long)filter.accepted_ids, filter.exact ? "exact" : "software check");
+  }
+  return true;
+}
+
+// Зупиняє драйвер перед зміною режиму. Під txMutex: canTransmit() з інших задач
+// не звернеться до драйвера посеред видалення. Кадри в черзі вже нікому не потрібні.
+void stopTwai() {
+  xSemaphoreTake(txMutex, portMAX_DELAY);
+  can_bus_running.store(false);
+  twai_stop();
+  twai_driver_uninstall();
+  tx_queue.clear();
+  xSemaphoreGive(txMutex);
+}
+
+// Передає кадр без очікування. priority: 0 - найвищий (індекс ECU, як арбітраж за ID).
+// false - кадр відкинуто (програмна черга заповнена кадрами з вищим пріоритетом).
+bool canTransmit(const CanFrame &frame, uint8_t priority) {
+  if (can_listen_only.load()) return false; // На шині нас немає
+  xSemaphoreTake(txMutex, portMAX_DELAY);
+  bool ok = false;
+  // Поки в програмній черзі щось є, нові кадри стають за ними - порядок ISO-TP зберігається
+  if (tx_queue.empty() && can_bus_running.load()) {
+    const twai_message_t message = toTwaiMessage(frame);
+    ok = twai_transmit(&message, 0) == ESP_OK;
+    if (ok) {
+      can_counters.tx_direct++;
+      can_recorder.record(frame, esp_timer_get_time(), true);
+    }
+  }
+  if (!ok) {
+    ok = tx_queue.push(frame, priority, micros() + TX_DEADLINE_US);
+  }
+  xSemaphoreGive(txMutex);
+  return ok;
+}
+
+// Доливає програмну чергу в драйвер, поки в ньому є місце. Лише CAN-задача.
+void pumpTxQueue() {
+  if (!can_bus_running.load()) return;
+  xSemaphoreTake(txMutex, portMAX_DELAY);
+  CanFrame frame;
+  while (tx_queue.front(micros(), frame)) {
+    const twai_message_t message = toTwaiMessage(frame);
+    if (twai_transmit(&message, 0) != ESP_OK) break;
+    can_recorder.record(frame, esp_timer_get_time(), true);
+    tx_queue.popFront();
+  }
+  xSemaphoreGive(txMutex);
+}
+
+twai_message_t toTwaiMessage(const CanFrame &frame) {
+  twai_message_t message = {};
+  message.extd = isExtendedCanId(frame.id) ? 1 : 0;
+  message.identifier = rawCanId(frame.id);
+  message.data_length_code = frame.dlc;
+  memcpy(message.data, frame.data, CAN_MAX_DLC);
+  return message;
+}
+
+CanFrame fromTwaiMessage(const twai_message_t &message) {
+  CanFrame frame = {};
+  frame.id = message.extd ? (message.identifier | CAN_EXTENDED_FLAG) : message.identifier;
+  frame.dlc = message.data_length_code > CAN_MAX_DLC ? CAN_MAX_DLC : message.data_length_code;
+  memcpy(frame.data, message.data, frame.dlc);
+  return frame;
+}
+
+// Bus-off -> автоматичне відновлення; кадр "висить" у контролері (немає ACK) -> скидання.
+void handleBusAlerts(uint32_t alerts) {
+  const uint32_t now = micros();
+  if (alerts & (TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_IDLE)) {
+    tx_last_progress_us.store(now);
+  }
+  if (alerts & TWAI_ALERT_ERR_PASS) {
+    can_counters.error_passive++;
+  }
+  if (alerts & TWAI_ALERT_BUS_OFF) {
+    can_bus_running.store(false);
+    can_counters.bus_off++;
+    logEvent(EVT_BUS_OFF);
+    twai_initiate_recovery(); // 128 x 11 рецесивних бітів, далі алерт BUS_RECOVERED
+  }
+  if (alerts & TWAI_ALERT_BUS_RECOVERED) {
+    if (twai_start() == ESP_OK) {
+      can_bus_running.store(true);
+      tx_last_progress_us.store(now);
+      can_counters.recoveries++;
+      logEvent(EVT_BUS_RECOVERED);
+    }
+  }
 
-      // Емуляція бідної суміші (P0171) при низькому тиску пального
-      if (lean_mixture_simulation_enabled) {
-          fuel_pressure = 150 + (rand() % 30); // Імітуємо падіння тиску до ~165 kPa
-          // Якщо тиск низький (< 200 kPa) і є навантаження (RPM > 2000)
-          if (fuel_pressure < 200 && engine_rpm > 2000) {
-              if (addDTC("P0171")) {
-                  notifyClients();
-                  updateDisplay();
-              }
-          }
+  if (!can_bus_running.load()) return;
+  twai_status_info_t status;
+  if (twai_get_status_info(&status) != ESP_OK || status.msgs_to_tx == 0) {
+    tx_last_progress_us.store(now);
+    return;
+  }
+  if (now - tx_last_progress_us.load() > TX_STALL_TIMEOUT_US) {
+    // Без жодного вузла з ACK контролер повторює кадр безкінечно (error passive
+    // не переходить у bus-off). Зупинка контролера скасовує передачу і чергу драйвера.
+    twai_stop();
+    twai_start();
+    tx_last_progress_us.store(now);
+    can_counters.stall_resets++;
+    logEvent(EVT_TX_STALLED, LOG_NO_ECU, status.msgs_to_tx);
+  }
+}
+
+String getCanStatsJson() {
+  xSemaphoreTake(txMutex, portMAX_DELAY);
+  const TxQueue::Stats queue = tx_queue.stats();
+  const size_t queued_now = tx_queue.size();
+  xSemaphoreGive(txMutex);
+
+  twai_status_info_t status = {};
+  twai_get_status_info(&status);
+
+  String json = "{";
+  json += "\"state\":" + String((int)status.state) + ",";
+  json += "\"tx_direct\":" + String(can_counters.tx_direct.load()) + ",";
+  json += "\"tx_queued\":" + String(queue.queued) + ",";
+  json += "\"tx_pending\":" + String((unsigned)queued_now) + ",";
+  json += "\"tx_dropped_full\":" + String(queue.dropped_full) + ",";
+  json += "\"tx_evicted\":" + String(queue.evicted) + ",";
+  json += "\"tx_expired\":" + String(queue.expired) + ",";
+  json += "\"tx_failed\":" + String(status.tx_failed_count) + ",";
+  json += "\"tx_error_counter\":" + String(status.tx_error_counter) + ",";
+  json += "\"rx_error_counter\":" + String(status.rx_error_counter) + ",";
+  json += "\"rx_missed\":" + String(status.rx_missed_count) + ",";
+  json += "\"rx_overrun\":" + String(status.rx_overrun_count) + ",";
+  json += "\"arb_lost\":" + String(status.arb_lost_count) + ",";
+  json += "\"bus_errors\":" + String(status.bus_error_count) + ",";
+  json += "\"error_passive\":" + String(can_counters.error_passive.load()) + ",";
+  json += "\"bus_off\":" + String(can_counters.bus_off.load()) + ",";
+  json += "\"recoveries\":" + String(can_counters.recoveries.load()) + ",";
+  json += "\"stall_resets\":" + String(can_counters.stall_resets.load()) + ",";
+  json += "\"listen_only\":" + String(can_listen_only.load() ? "true" : "false");
+  json += "}";
+  return json;
+}
+
+// Задача запису: скидає кадри з can_recorder у RECORD_PATH порціями по RECORD_BATCH.
+// Файлом володіє лише вона; веб-обробники керують нею через record_requested.
+void recordTask(void *arg) {
+  File file;
+  size_t limit = 0;
+  CanRecord batch[RECORD_BATCH];
+  for (;;) {
+    const bool requested = record_requested.load();
+    if (requested && !file) {
+      LittleFS.remove(RECORD_PATH);
+      file = LittleFS.open(RECORD_PATH, FILE_WRITE);
+      if (!file) {
+        Serial.println("Failed to create CAN recording in LittleFS");
+        record_requested.store(false);
+      } else {
+        const size_t total = LittleFS.totalBytes();
+        const size_t used = LittleFS.usedBytes();
+        const size_t free_bytes = total > used + RECORD_FS_RESERVE ? total - used - RECORD_FS_RESERVE : 0;
+        limit = free_bytes < RECORD_MAX_BYTES ? free_bytes : RECORD_MAX_BYTES;
+        record_frames.store(0);
+        record_dropped.store(0);
+        while (can_recorder.pop(batch[0])) {} // Запізнілі кадри попереднього запису
+        can_recorder.takeDropped();
+        record_file_open.store(true);
+        can_recorder.start();
+        Serial.printf("CAN recording started (up to %u bytes)\n", (unsigned)limit);
+      }
+    }
+    if (!requested) can_recorder.stop(); // Дописуємо те, що вже в буфері, і закриваємо
+
+    if (file) {
+      bool full = false;
+      int n;
+      do {
+        n = 0;
+        while (n < RECORD_BATCH && can_recorder.pop(batch[n])) n++;
+        full = file.size() + n * sizeof(CanRecord) > limit;
+        if (n > 0 && !full) {
+          file.write((const uint8_t *)batch, n * sizeof(CanRecord));
+          record_frames.fetch_add(n);
+        }
+      } while (n == RECORD_BATCH && !full);
+      if (full) {
+        Serial.println("CAN recording stopped: size limit reached");
+        record_requested.store(false);
+        can_recorder.stop();
+        record_dropped.fetch_add(n);
+        while (can_recorder.pop(batch[0])) record_dropped.fetch_add(1);
+      }
+      record_dropped.fetch_add(can_recorder.takeDropped());
+      if (!can_recorder.recording()) {
+        file.close();
+        record_file_open.store(false);
+        Serial.printf("CAN recording stopped: %lu frames, %lu dropped\n",
+                      (unsigned long)record_frames.load(), (unsigned long)record_dropped.load());
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(RECORD_FLUSH_PERIOD_MS));
+  }
+}
+
+String getRecordStatusJson() {
+  String json = "{";
+  json += "\"recording\":" + String(record_file_open.load() ? "true" : "false") + ",";
+  json += "\"listen_only\":" + String(can_listen_only.load() ? "true" : "false") + ",";
+  json += "\"frames\":" + String(record_frames.load()) + ",";
+  json += "\"dropped\":" + String(record_dropped.load());
+  json += "}";
+  return json;
+}
+
+// Записи з файлу запису для CandumpStream
+class RecordFileSource : public CanRecordSource {
+public:
+    explicit RecordFileSource(File file) : file_(file) {}
+    ~RecordFileSource() { file_.close(); }
+    bool next(CanRecord &record) override {
+        return file_.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+    }
+
+private:
+    File file_;
+};
+
+// Віддає запис як текст `candump -l` chunked-відповіддю: рядки генеруються
+// під кожну порцію TCP, а не цілим файлом у RAM.
+void sendRecording(AsyncWebServerRequest *request) {
+    if (record_requested.load() || record_file_open.load()) {
+        request->send(409, "text/plain", "Recording in progress: stop it first (/record?stop)");
+        return;
+    }
+    File file = LittleFS.open(RECORD_PATH, FILE_READ);
+    if (!file) {
+        request->send(404, "text/plain", "No CAN recording (/record?start)");
+        return;
+    }
+    struct Download {
+        RecordFileSource source;
+        CandumpStream stream;
+        explicit Download(File file) : source(file), stream(source, RECORD_IFACE) {}
+    };
+    std::shared_ptr<Download> download = std::make_shared<Download>(file);
+    AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain",
+        [download](uint8_t *buffer, size_t max_len, size_t) -> size_t {
+            return download->stream.read(buffer, max_len);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"can_record.log\"");
+    request->send(response);
+}
+
+// Задача журналу: виводить накопичені записи порціями, не частіше LOG_DRAIN_BUDGET
+// рядків за LOG_DRAIN_PERIOD_MS. Блокується на UART лише вона сама.
+void logTask(void *arg) {
+  char line[128];
+  for (;;) {
+    uint32_t dropped = event_log.takeDropped();
+    if (dropped > 0) {
+      Serial.printf("[log] %lu events dropped\n", (unsigned long)dropped);
+    }
+    LogEvent event;
+    for (int i = 0; i < LOG_DRAIN_BUDGET && event_log.pop(event); i++) {
+      const char *ecu_name = event.ecu < NUM_ECUS ? ecus[event.ecu].config.name : nullptr;
+      formatLogEvent(event, ecu_name, line, sizeof(line));
+      Serial.println(line);
+    }
+    vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+  }
+}
+
+// Безпечно викликати з будь-якої задачі: лише копіює запис у кільцевий буфер.
+void logEvent(LogEventType type, uint8_t ecu, uint32_t value,
+              uint8_t service, uint8_t pid, uint8_t count, uint16_t length) {
+  if (!event_log.enabled(type)) return;
+  LogEvent event = {};
+  event.timestamp_us = micros();
+  event.value = value;
+  event.length = length;
+  event.type = type;
+  event.ecu = ecu;
+  event.service = service;
+  event.pid = pid;
+  event.count = count;
+  event_log.push(event);
+}
+
+// Рахує ETag стиснутих файлів веб-інтерфейсу: один раз, вміст LittleFS
+// змінюється лише разом з перепрошивкою образу.
+void setupWebAssets() {
+    if (!LittleFS.begin()) {
+        Serial.println("LittleFS mount failed: web UI unavailable (pio run -t uploadfs)");
+    }
+    for (size_t i = 0; i < NUM_WEB_ASSETS; i++) {
+        web_asset_etags[i][0] = '\0';
+        File file = LittleFS.open(String(WEB_ASSETS[i].path) + ".gz", "r");
+        if (!file) {
+            Serial.printf("Web asset %s.gz not found in LittleFS\n", WEB_ASSETS[i].path);
+            continue;
+        }
+        uint8_t buf[512];
+        uint32_t hash = webAssetHash(nullptr, 0);
+        size_t n;
+        while ((n = file.read(buf, sizeof(buf))) > 0) hash = webAssetHash(buf, n, hash);
+        formatWebEtag(hash, file.size(), web_asset_etags[i]);
+        file.close();
+    }
+}
+
+void serveWebAsset(AsyncWebServerRequest *request, size_t index) {
+    const WebAsset &asset = WEB_ASSETS[index];
+    const char *etag = web_asset_etags[index];
+    if (!etag[0]) {
+        request->send(503, "text/plain", "Web UI is not in LittleFS: run 'pio run -t uploadfs'");
+        return;
+    }
+
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") &&
+        webEtagMatches(request->getHeader("If-None-Match")->value().c_str(), etag)) {
+        response = request->beginResponse(304);
+    } else {
+        // Є лише <path>.gz: AsyncFileResponse сам віддає його з Content-Encoding: gzip
+        response = request->beginResponse(LittleFS, asset.path, asset.content_type);
+    }
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", WEB_CACHE_CONTROL);
+    request->send(response);
+}
+
+void requestUiRefresh() {
+  ui_refresh_pending.store(true);
+  requestDisplayUpdate();
+}
+
+void loop() {
+  if (ui_refresh_pending.exchange(false)) {
+      notifyClients();
+  }
+
+  // Симуляцію рахує simTask; тут - лише частота оновлення клієнтів
+  const unsigned long now = millis();
+  if (simulation_running.load()) {
+      static unsigned long last_binary_notify = 0;
+      if (now - last_binary_notify >= WS_BINARY_INTERVAL_MS) {
+          last_binary_notify = now;
+          notifyClients(WS_FORMAT_BINARY);
       }
 
       static unsigned long last_dynamic_notify = 0;
-      // Оновлюємо веб-інтерфейс та дисплей не частіше ніж раз на 500 мс, щоб не перевантажувати
-      if (now - last_dynamic_notify > 500) {
+      // JSON-клієнти та дисплей - не частіше ніж раз на 500 мс, щоб не перевантажувати
+      if (now - last_dynamic_notify > WS_JSON_INTERVAL_MS) {
           last_dynamic_notify = now;
-          notifyClients();
-          updateDisplay();
+          notifyClients(WS_FORMAT_JSON);
+          requestDisplayUpdate();
       }
   }
   ws.cleanupClients();
+  delay(10); // CAN і симуляція - окремі задачі; loop() лише для веб-клієнтів
 }
 
-void updateDisplay() {
-  tft.fillScreen(ST7735_BLACK);
-  tft.setCursor(0, 0);
-  tft.setTextSize(1);
-  
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println("OBD-II EMULATOR STATUS");
-  
-  tft.setTextColor(ST7735_WHITE);
-  tft.print("VIN: ");
-  tft.println(vin);
-  tft.println(""); // Spacer
-
-  char buf1[15], buf2[15];
-
-  // Line 1: RPM & Speed
-  snprintf(buf1, sizeof(buf1), "RPM: %d", engine_rpm);
-  snprintf(buf2, sizeof(buf2), "Speed: %d", vehicle_speed);
-  tft.printf("%-14s%s\n", buf1, buf2);
-
-  // Line 2: Temp & MAF
-  snprintf(buf1, sizeof(buf1), "Temp: %dC", engine_temp);
-  snprintf(buf2, sizeof(buf2), "MAF: %.1f", maf_rate);
-  tft.printf("%-14s%s\n", buf1, buf2);
-
-  // Line 3: Fuel & Voltage
-  snprintf(buf1, sizeof(buf1), "Fuel: %.0f%%", fuel_level);
-  snprintf(buf2, sizeof(buf2), "Volt: %.1f", battery_voltage);
-  tft.printf("%-14s%s\n", buf1, buf2);
-
-  // Line 4: Dist MIL & Cycles
-  snprintf(buf1, sizeof(buf1), "MIL km: %d", distance_with_mil);
-  snprintf(buf2, sizeof(buf2), "Cyc: %d/%d", error_free_cycles, CYCLES_THRESHOLD);
-  tft.printf("%-14s%s\n", buf1, buf2);
-
-  tft.println(""); // Spacer
-
-  tft.println("DTCs:");
-  if (num_dtcs > 0) {
-    tft.setTextColor(ST7735_RED);
-    String dtc_line = "";
-    for(int i=0; i<num_dtcs; i++) {
-        dtc_line += String(dtcs[i]) + " ";
-    }
-    tft.println(dtc_line);
-  } else {
-    tft.setTextColor(ST7735_GREEN);
-    tft.println("  None");
+void simTask(void *arg) {
+  bool model_running = false;
+  TickType_t last_wake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&last_wake, SIM_PERIOD_TICKS);
+    // Траса має пріоритет над моделлю dynamic_rpm
+    const bool trace_running = stepTrace();
+    const bool model_was_running = model_running;
+    model_running = !trace_running && vehicle.read().dynamic_rpm_enabled;
+    if (model_running) stepSimulation(!model_was_running);
+    simulation_running.store(trace_running || model_running);
   }
 }
 
-String getJsonState() {
-    String json = "{";
-    json += "\"vin\":\"" + String(vin) + "\",";
-    json += "\"cal_id\":\"" + String(cal_id) + "\",";
-    json += "\"cvn\":\"" + String(cvn) + "\",";
-    json += "\"rpm\":" + String(engine_rpm) + ",";
-    json += "\"temp\":" + String(engine_temp) + ",";
-    json += "\"speed\":" + String(vehicle_speed) + ",";
-    json += "\"maf\":" + String(maf_rate, 2) + ",";
-    json += "\"timing\":" + String(timing_advance, 1) + ",";
-    json += "\"fuel_rate\":" + String(fuel_rate, 2) + ",";
-    json += "\"fuel_pressure\":" + String(fuel_pressure) + ",";
-    json += "\"fuel\":" + String(fuel_level, 1) + ",";
-    json += "\"dist_mil\":" + String(distance_with_mil) + ",";
-    json += "\"voltage\":" + String(battery_voltage, 1) + ",";
-    json += "\"cycles\":" + String(error_free_cycles) + ",";
-    json += "\"dynamic_rpm\":" + String(dynamic_rpm_enabled ? "true" : "false") + ",";
-    json += "\"misfire_sim\":" + String(misfire_simulation_enabled ? "true" : "false") + ",";
-    json += "\"lean_mixture_sim\":" + String(lean_mixture_simulation_enabled ? "true" : "false") + ",";
-    json += "\"dtcs\":[";
-    if (num_dtcs > 0) {
-        for(int i=0; i<num_dtcs; i++) {
-            json += "\"" + String(dtcs[i]) + "\"";
-            if (i < num_dtcs - 1) {
-                json += ",";
+// Один крок моделі руху. restart - модель щойно ввімкнули: починає з поточного стану.
+void stepSimulation(bool restart) {
+    const char *new_dtc = nullptr;
+    updateVehicleState([&](VehicleState &s) {
+        if (restart) vehicle_sim.reset(s);
+        new_dtc = vehicle_sim.step(s);
+    });
+
+    // Якщо додали новий DTC, одразу оновлюємо інтерфейси
+    if (new_dtc) {
+        uint8_t code[2];
+        encodeDtc(new_dtc, code);
+        logEvent(EVT_DTC_ADDED, LOG_NO_ECU, (code[0] << 8) | code[1]);
+        requestUiRefresh();
+    }
+}
+
+// Просуває відтворювану трасу і публікує її значення. false - траса не грає.
+bool stepTrace() {
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+    if (!trace_player.active()) {
+        xSemaphoreGive(traceMutex);
+        return false;
+    }
+    const bool playing = trace_player.advance(esp_timer_get_time());
+    int added = 0;
+    uint8_t new_dtcs[MAX_DTCS][2];
+    updateVehicleState([&](VehicleState &s) {
+        added = trace_player.apply(s);
+        // Нові коди addDTC() дописує в кінець списку
+        for (int i = 0; i < added; i++) encodeDtc(s.dtcs[s.num_dtcs - added + i], new_dtcs[i]);
+    });
+    if (!playing) {
+        Serial.printf("Trace finished: %lu ms, %lu lines skipped\n",
+                      (unsigned long)trace_player.positionMs(), (unsigned long)trace_player.skippedLines());
+        trace_player.stop();
+        trace_reader.close();
+    }
+    xSemaphoreGive(traceMutex);
+
+    for (int i = 0; i < added; i++) {
+        logEvent(EVT_DTC_ADDED, LOG_NO_ECU, (new_dtcs[i][0] << 8) | new_dtcs[i][1]);
+    }
+    if (added > 0 || !playing) requestUiRefresh();
+    return true;
+}
+
+// Обробник /trace (задача AsyncTCP). Повертає текст помилки або "".
+String startTrace(AsyncWebServerRequest *request) {
+    String error;
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+    trace_player.stop();
+    trace_reader.close();
+    if (!request->hasParam("stop")) {
+        if (!request->hasParam("file")) {
+            error = "Missing 'file' parameter";
+        } else {
+            const String path = request->getParam("file")->value();
+            const float speed = request->hasParam("speed") ? request->getParam("speed")->value().toFloat() : 1.0f;
+            const bool loop = !request->hasParam("loop") || request->getParam("loop")->value() != "0";
+            if (!trace_reader.open(path)) {
+                error = "Trace not found in LittleFS: " + path;
+            } else if (!trace_player.begin(trace_reader, esp_timer_get_time(), speed, loop)) {
+                error = String("Bad trace: ") + trace_player.error();
+                trace_reader.close();
+            } else {
+                Serial.printf("Trace %s started (x%.2f%s)\n", path.c_str(), speed, loop ? ", loop" : "");
             }
         }
     }
-    json += "],";
-    json += "\"permanent_dtcs\":[";
-    if (num_permanent_dtcs > 0) {
-        for(int i=0; i<num_permanent_dtcs; i++) {
-            json += "\"" + String(permanent_dtcs[i]) + "\"";
-            if (i < num_permanent_dtcs - 1) {
-                json += ",";
+    xSemaphoreGive(traceMutex);
+    return error;
+}
+
+void displayTask(void *arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Скидає лічильник: кілька запитів - один рендер
+    status_display.render(vehicle.read());
+  }
+}
+
+// Безпечно викликати з будь-якої задачі
+void requestDisplayUpdate() {
+  if (displayTaskHandle) xTaskNotifyGive(displayTaskHandle);
+}
+
+// Одне повідомлення на всіх адресатів: буфер AsyncWebSocket з лічильником посилань.
+// client->text(data, len) натомість копіює дані в окрему алокацію для кожного клієнта.
+class WsSharedMessage {
+public:
+    explicit WsSharedMessage(const void *data) : data_(data) {}
+    WsSharedMessage(const WsSharedMessage &) = delete;
+    WsSharedMessage &operator=(const WsSharedMessage &) = delete;
+
+    ~WsSharedMessage() {
+        if (!buffer_) return;
+        buffer_->unlock();
+        ws._cleanBuffers(); // Звільняє буфер, коли його відправлять усім клієнтам
+    }
+
+    // Буфер створюється при першому адресаті; nullptr - немає пам'яті.
+    // len має бути однаковим в усіх викликах.
+    AsyncWebSocketMessageBuffer *get(size_t len) {
+        if (!buffer_) {
+            buffer_ = ws.makeBuffer(len);
+            if (!buffer_) return nullptr;
+            memcpy(buffer_->get(), data_, len);
+            buffer_->lock();
+        }
+        return buffer_;
+    }
+
+private:
+    const void *data_;
+    AsyncWebSocketMessageBuffer *buffer_ = nullptr;
+};
+
+// Надсилає стан клієнтам обраних форматів. Кодування - у статичні буфери, і лише
+// коли змінилася версія стану; кожне повідомлення - одне спільне на всіх клієнтів.
+// JSON: дельта відносно попереднього виклику, ключовий кадр - новим клієнтам та
+// раз на WS_KEYFRAME_INTERVAL_MS. Викликається лише з loop(): статичні змінні - її стан.
+void notifyClients(uint8_t formats) {
+    static VehicleState json_sent; // База дельт
+    static bool json_sent_valid = false;
+    static unsigned long last_keyframe = 0;
+    static char keyframe[STATE_JSON_MAX];
+    static size_t keyframe_len = 0;
+    static uint32_t keyframe_version = 0;
+    static char delta[STATE_JSON_MAX];
+    static uint8_t frame[TELEMETRY_FRAME_SIZE];
+    static bool frame_valid = false;
+    static uint32_t frame_version = 0;
+
+    const VehicleState s = vehicle.read();
+    size_t delta_len = 0;
+    bool periodic_keyframe = false;
+    if (formats & WS_FORMAT_JSON) {
+        const unsigned long now = millis();
+        periodic_keyframe = !json_sent_valid || now - last_keyframe >= WS_KEYFRAME_INTERVAL_MS;
+        if (periodic_keyframe) {
+            last_keyframe = now;
+        } else if (s.version != json_sent.version) {
+            delta_len = writeStateJson(s, &json_sent, delta, sizeof(delta));
+        }
+        json_sent = s;
+        json_sent_valid = true;
+    }
+
+    WsSharedMessage keyframe_message(keyframe);
+    WsSharedMessage delta_message(delta);
+    WsSharedMessage frame_message(frame);
+
+    for (WsClientSlot &slot : ws_clients) {
+        const uint32_t id = slot.id.load();
+        AsyncWebSocketClient *client = id != 0 ? ws.client(id) : nullptr;
+        if (!client) continue;
+
+        if (slot.binary.load()) {
+            if (!(formats & WS_FORMAT_BINARY)) continue;
+            if (!frame_valid || frame_version != s.version) {
+                encodeTelemetry(s, frame);
+                frame_valid = true;
+                frame_version = s.version;
+            }
+            if (AsyncWebSocketMessageBuffer *message = frame_message.get(sizeof(frame))) client->binary(message);
+        } else {
+            if (!(formats & WS_FORMAT_JSON)) continue;
+            if (slot.keyframe.exchange(false) || periodic_keyframe) {
+                if (keyframe_len == 0 || keyframe_version != s.version) {
+                    keyframe_len = writeStateJson(s, nullptr, keyframe, sizeof(keyframe));
+                    keyframe_version = s.version;
+                }
+                AsyncWebSocketMessageBuffer *message = keyframe_len ? keyframe_message.get(keyframe_len) : nullptr;
+                if (message) client->text(message);
+            } else if (delta_len) {
+                if (AsyncWebSocketMessageBuffer *message = delta_message.get(delta_len)) client->text(message);
             }
         }
     }
-    json += "]}";
-    return json;
 }
 
-void notifyClients() {
-    ws.textAll(getJsonState());
+WsClientSlot *findWsClient(uint32_t id) {
+    for (WsClientSlot &slot : ws_clients) {
+        if (slot.id.load() == id) return &slot;
+    }
+    return nullptr;
 }
 
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len){
   if(type == WS_EVT_CONNECT){
     Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
-    // Відправляємо поточний стан новому клієнту
-    client->text(getJsonState());
+    WsClientSlot *slot = findWsClient(0);
+    if (!slot) {
+      // Без слота клієнт не отримував би стану взагалі (notifyClients() обходить лише ws_clients)
+      Serial.printf("WebSocket client #%u rejected: all %d slots busy\n", client->id(), MAX_WS_CLIENTS);
+      client->close();
+      return;
+    }
+    slot->binary.store(false);
+    slot->keyframe.store(true);
+    slot->id.store(client->id());
+    // Поточний стан (JSON, доки клієнт не попросить "bin") надішле loop(): лише там
+    // відомо, від якого стану рахуються дельти
+    requestUiRefresh();
   } else if(type == WS_EVT_DISCONNECT){
     Serial.printf("WebSocket client #%u disconnected\n", client->id());
+    WsClientSlot *slot = findWsClient(client->id());
+    if (slot) slot->id.store(0);
+  } else if(type == WS_EVT_DATA){
+    // Вибір формату: коротке текстове повідомлення в одному кадрі
+    AwsFrameInfo *info = (AwsFrameInfo*)arg;
+    WsClientSlot *slot = findWsClient(client->id());
+    if (!slot || !info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) return;
+    if (len == 3 && memcmp(data, "bin", 3) == 0) {
+      slot->binary.store(true);
+      uint8_t frame[TELEMETRY_FRAME_SIZE];
+      encodeTelemetry(vehicle.read(), frame);
+      client->binary(frame, sizeof(frame));
+    } else if (len == 4 && memcmp(data, "json", 4) == 0) {
+      slot->binary.store(false);
+      slot->keyframe.store(true);
+      requestUiRefresh();
+    }
   } else if(type == WS_EVT_ERROR){
     Serial.printf("WebSocket client #%u error(%u): %s\n", client->id(), *((uint16_t*)arg), (char*)data);
   } else if(type == WS_EVT_PONG){
@@ -457,538 +1091,112 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
   }
 }
 
-// Допоміжна функція для додавання DTC, якщо він ще не існує
-bool addDTC(const char* new_dtc) {
-    bool added_to_current = false;
-    bool added_to_permanent = false;
+void completeDrivingCycle() {
+    int cycles = 0;
+    bool permanent_cleared = false;
+    updateVehicleState([&](VehicleState &s) {
+        permanent_cleared = applyDrivingCycle(s);
+        cycles = s.error_free_cycles;
+    });
+    logEvent(EVT_DRIVING_CYCLE, LOG_NO_ECU, cycles, 0, 0, permanent_cleared);
+    requestUiRefresh();
+}
 
-    // Додаємо до поточних DTC, якщо є місце і код ще не існує
-    if (num_dtcs < 5) {
-        bool exists = false;
-        for (int i = 0; i < num_dtcs; i++) {
-            if (strcmp(dtcs[i], new_dtc) == 0) {
-                exists = true;
-                break;
-            }
-        }
-        if (!exists) {
-            strncpy(dtcs[num_dtcs], new_dtc, 5);
-            dtcs[num_dtcs][5] = '\0';
-            num_dtcs++;
-            added_to_current = true;
-        }
+// ############## Платформа для lib/obd_core ##############
+class Esp32ObdHal : public ObdHal {
+public:
+    uint32_t micros() override { return ::micros(); }
+
+    bool transmit(const CanFrame &frame, uint8_t priority) override {
+        return canTransmit(frame, priority);
     }
 
-    // Додаємо до постійних DTC, якщо є місце і код ще не існує
-    if (num_permanent_dtcs < 5) {
-        bool exists = false;
-        for (int i = 0; i < num_permanent_dtcs; i++) {
-            if (strcmp(permanent_dtcs[i], new_dtc) == 0) {
-                exists = true;
-                break;
-            }
-        }
-        if (!exists) {
-            strncpy(permanent_dtcs[num_permanent_dtcs], new_dtc, 5);
-            permanent_dtcs[num_permanent_dtcs][5] = '\0';
-            num_permanent_dtcs++;
-            added_to_permanent = true;
-        }
+    void armTimer(ObdEcu &ecu, ObdTimer timer, uint32_t delay_us) override {
+        esp_timer_handle_t handle = ecu_platform[ecu.index()].timers[timer];
+        esp_timer_stop(handle);
+        esp_timer_start_once(handle, delay_us);
     }
 
-    if (added_to_current || added_to_permanent) {
-        Serial.printf("Misfire detected! Added DTC: %s. Current: %d, Permanent: %d\n", new_dtc, num_dtcs, num_permanent_dtcs);
-        return true; // Повертаємо true, якщо код було додано хоча б до одного списку
+    void lock(ObdEcu &ecu) override { xSemaphoreTake(ecu_platform[ecu.index()].mutex, portMAX_DELAY); }
+    void unlock(ObdEcu &ecu) override { xSemaphoreGive(ecu_platform[ecu.index()].mutex); }
+
+    VehicleState readState() override { return vehicle.read(); }
+
+    void clearDtcs(ObdEcu &) override { clearStoredDtcs(); }
+
+    void log(const LogEvent &event) override {
+        if (event_log.enabled((LogEventType)event.type)) event_log.push(event);
     }
-    return false;
+};
+
+Esp32ObdHal obd_hal;
+
+// 29-бітний ECU описується так само, напр.:
+//  {"ECM", 0x18DA10F1 | CAN_EXTENDED_FLAG, 0x18DAF110 | CAN_EXTENDED_FLAG, &SERVICE01, &SERVICE02, &SERVICE06, 0, true, &SERVICE09},
+ObdEcu ecus[NUM_ECUS] = {
+    //           name   request  response  service01        service02   service06   functional delay  DTC    service09
+    ObdEcuConfig{"ECM", 0x7E0,   0x7E8,    &SERVICE01,      &SERVICE02, &SERVICE06, 0,                true,  &SERVICE09},
+    ObdEcuConfig{"TCM", 0x7E1,   0x7E9,    &TCM_SERVICE01,  nullptr,    nullptr,    3000,             false, &TCM_SERVICE09},
+};
+
+void onIsoTpTimer(void *arg) {
+    ((ObdEcu *)arg)->onTimer(OBD_TIMER_ISOTP);
 }
 
-void completeDrivingCycle() {
-    Serial.println("Simulating Driving Cycle...");
-    if (num_dtcs == 0) {
-        error_free_cycles++;
-        Serial.printf("  No current DTCs. Error-free cycles: %d/%d\n", error_free_cycles, CYCLES_THRESHOLD);
-        
-        if (error_free_cycles >= CYCLES_THRESHOLD) {
-            if (num_permanent_dtcs > 0) {
-                num_permanent_dtcs = 0;
-                for(int i=0; i<5; i++) permanent_dtcs[i][0] = '\0';
-                Serial.println("  Threshold reached! Permanent DTCs cleared.");
-            }
-            // Скидаємо лічильник після успішного очищення (або можна залишити, щоб показувати "здоров'я")
-            // error_free_cycles = 0; 
-        }
-    } else {
-        error_free_cycles = 0;
-        Serial.println("  Current DTCs present. Error-free cycles counter reset to 0.");
-    }
-    updateDisplay();
-    notifyClients();
-}
-
-void handleOBDRequest(const twai_message_t &frame) {
-    byte service = frame.data[1];
-    byte pid = frame.data[2];
-
-    Serial.printf("Received OBD Request: Service 0x%02X, PID 0x%02X\n", service, pid);
-
-    switch(service) {
-        case 0x01: sendCurrentData(pid); break;
-        case 0x03: sendDTCs(); break;
-        case 0x04: clearDTCs(); break;
-        case 0x09: 
-            if (pid == 0x00) sendSupportedPids_09(pid);
-            else if (pid == 0x02) sendVIN(pid);
-            else if (pid == 0x04) sendCalId(pid);
-            else if (pid == 0x06) sendCvn(pid);
-            break;
-        case 0x0A: sendPermanentDTCs(); break;
-    }
-}
-
-void sendCurrentData(byte pid) {
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8; // OBD_CAN_ID_RESPONSE
-    tx_frame.extd = 0;
-    tx_frame.data[1] = 0x40 + 0x01; // Відповідь на сервіс 01
-    tx_frame.data[2] = pid;
-
-    switch(pid) {
-        case 0x00: { // Supported PIDs [01-20]
-            // Кожен біт відповідає за підтримку одного PID.
-            // Біт 31 (MSB) -> PID 0x01, ..., Біт 0 (LSB) -> PID 0x20.
-            // Ми підтримуємо: 0x05, 0x0C, 0x0D, 0x10
-            uint32_t supported_pids = 0;
-            supported_pids |= (1UL << (32 - 0x01)); // Monitor status
-            supported_pids |= (1UL << (32 - 0x05)); // Temp
-            supported_pids |= (1UL << (32 - 0x0A)); // Fuel Pressure
-            supported_pids |= (1UL << (32 - 0x0E)); // Timing Advance
-            supported_pids |= (1UL << (32 - 0x0C)); // RPM
-            supported_pids |= (1UL << (32 - 0x0D)); // Speed
-            supported_pids |= (1UL << (32 - 0x10)); // MAF
-            supported_pids |= (1UL << (32 - 0x20)); // Announce support for PIDs 21-40
-
-            tx_frame.data[0] = 6; // Length: 1 (service) + 1 (PID) + 4 (data)
-            tx_frame.data_length_code = 1 + 6;
-            tx_frame.data[3] = (supported_pids >> 24) & 0xFF; // MSB
-            tx_frame.data[4] = (supported_pids >> 16) & 0xFF;
-            tx_frame.data[5] = (supported_pids >> 8) & 0xFF;
-            tx_frame.data[6] = supported_pids & 0xFF;        // LSB
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Supported PIDs [01-20] data");
-            break;
-        }
-        case 0x01: { // Monitor status since DTCs cleared
-            // Byte A: Bit 7 = MIL Status, Bits 0-6 = DTC Count
-            byte mil_dtc_count = num_dtcs & 0x7F;
-            if (num_dtcs > 0) {
-                mil_dtc_count |= 0x80; // Set MIL ON
-            }
-            tx_frame.data[0] = 6; // Length: 1 (service) + 1 (PID) + 4 (data)
-            tx_frame.data_length_code = 1 + 6;
-            tx_frame.data[3] = mil_dtc_count;
-            tx_frame.data[4] = 0x00; // Byte B (Tests supported/complete - simplified)
-            tx_frame.data[5] = 0x00; // Byte C
-            tx_frame.data[6] = 0x00; // Byte D
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Monitor Status (PID 0x01)");
-            break;
-        }
-        case 0x0A: { // Fuel Pressure
-            // Формула: A * 3 (kPa) -> A = val / 3
-            int val = fuel_pressure / 3;
-            tx_frame.data[0] = 3; 
-            tx_frame.data_length_code = 1 + 3;
-            tx_frame.data[3] = (byte)constrain(val, 0, 255);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Fuel Pressure data");
-            break;
-        }
-        case 0x0C: { // Engine RPM
-            // Формула: (A*256+B)/4
-            int rpm_value = engine_rpm * 4; 
-            tx_frame.data[0] = 4; // Length: 1 (service) + 1 (PID) + 2 (data)
-            tx_frame.data_length_code = 1 + 4;
-            tx_frame.data[3] = highByte(rpm_value);
-            tx_frame.data[4] = lowByte(rpm_value);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent RPM data");
-            break;
-        }
-        case 0x0E: { // Timing Advance
-            // Формула: (A-128)/2 => A = (val * 2) + 128
-            int val = (int)((timing_advance * 2) + 128);
-            tx_frame.data[0] = 3; 
-            tx_frame.data_length_code = 1 + 3;
-            tx_frame.data[3] = (byte)constrain(val, 0, 255);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Timing Advance data");
-            break;
-        }
-        case 0x05: { // Engine Coolant Temperature
-            // Формула: A-40
-            int temp_value = engine_temp + 40; 
-            tx_frame.data[0] = 3; // Length: 1 (service) + 1 (PID) + 1 (data)
-            tx_frame.data_length_code = 1 + 3;
-            tx_frame.data[3] = temp_value;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Engine Temp data");
-            break;
-        }
-        case 0x0D: { // Vehicle Speed
-            // Формула: A
-            tx_frame.data[0] = 3; // Length: 1 (service) + 1 (PID) + 1 (data)
-            tx_frame.data_length_code = 1 + 3;
-            tx_frame.data[3] = vehicle_speed;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Vehicle Speed data");
-            break;
-        }
-        case 0x10: { // MAF air flow rate
-            // Формула: (A*256+B)/100
-            int maf_value = maf_rate * 100;
-            tx_frame.data[0] = 4; // Length: 1 (service) + 1 (PID) + 2 (data)
-            tx_frame.data_length_code = 1 + 4;
-            tx_frame.data[3] = highByte(maf_value);
-            tx_frame.data[4] = lowByte(maf_value);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent MAF rate data");
-            break;
-        }
-        case 0x20: { // Supported PIDs [21-40]
-            uint32_t supported_pids_21_40 = 0;
-            supported_pids_21_40 |= (1UL << (32 - (0x2F - 0x20))); // Fuel Level
-            supported_pids_21_40 |= (1UL << (32 - (0x31 - 0x20))); // Dist with MIL
-            supported_pids_21_40 |= (1UL << (32 - (0x40 - 0x20))); // Support for 41-60
-
-            tx_frame.data[0] = 6; // Length: 1 (service) + 1 (PID) + 4 (data)
-            tx_frame.data_length_code = 1 + 6;
-            tx_frame.data[3] = (supported_pids_21_40 >> 24) & 0xFF;
-            tx_frame.data[4] = (supported_pids_21_40 >> 16) & 0xFF;
-            tx_frame.data[5] = (supported_pids_21_40 >> 8) & 0xFF;
-            tx_frame.data[6] = supported_pids_21_40 & 0xFF;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Supported PIDs [21-40] data");
-            break;
-        }
-        case 0x2F: { // Fuel Tank Level Input
-            // Формула: 100/255 * A
-            byte fuel_value = (fuel_level * 255.0) / 100.0;
-            tx_frame.data[0] = 3; // Length: 1 (service) + 1 (PID) + 1 (data)
-            tx_frame.data_length_code = 1 + 3;
-            tx_frame.data[3] = fuel_value;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Fuel Level data");
-            break;
-        }
-        case 0x31: { // Distance Traveled with MIL On
-            // Формула: A*256 + B
-            tx_frame.data[0] = 4; // Length: 1 (service) + 1 (PID) + 2 (data)
-            tx_frame.data_length_code = 1 + 4;
-            tx_frame.data[3] = highByte(distance_with_mil);
-            tx_frame.data[4] = lowByte(distance_with_mil);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Distance with MIL data");
-            break;
-        }
-        case 0x40: { // Supported PIDs [41-60]
-            uint32_t supported_pids_41_60 = 0;
-            supported_pids_41_60 |= (1UL << (32 - (0x5E - 0x40))); // Engine Fuel Rate
-            supported_pids_41_60 |= (1UL << (32 - (0x60 - 0x40))); // Support for 61-80
-
-            tx_frame.data[0] = 6;
-            tx_frame.data_length_code = 1 + 6;
-            tx_frame.data[3] = (supported_pids_41_60 >> 24) & 0xFF;
-            tx_frame.data[4] = (supported_pids_41_60 >> 16) & 0xFF;
-            tx_frame.data[5] = (supported_pids_41_60 >> 8) & 0xFF;
-            tx_frame.data[6] = supported_pids_41_60 & 0xFF;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            break;
-        }
-        case 0x5E: { // Engine Fuel Rate
-            // Формула: ((A*256)+B)/20 L/h => val = rate * 20
-            int val = (int)(fuel_rate * 20);
-            tx_frame.data[0] = 4;
-            tx_frame.data_length_code = 1 + 4;
-            tx_frame.data[3] = highByte(val);
-            tx_frame.data[4] = lowByte(val);
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            break;
-        }
-        case 0x60: { // Supported PIDs [61-80]
-            uint32_t supported_pids_61_80 = 0;
-            // No PIDs supported in this range yet.
-            // supported_pids_61_80 |= (1UL << (32 - (0xXX - 0x60))); 
-
-            tx_frame.data[0] = 6;
-            tx_frame.data_length_code = 1 + 6;
-            tx_frame.data[3] = (supported_pids_61_80 >> 24) & 0xFF;
-            tx_frame.data[4] = (supported_pids_61_80 >> 16) & 0xFF;
-            tx_frame.data[5] = (supported_pids_61_80 >> 8) & 0xFF;
-            tx_frame.data[6] = supported_pids_61_80 & 0xFF;
-            twai_transmit(&tx_frame, portMAX_DELAY);
-            Serial.println("Sent Supported PIDs [61-80] data");
-            break;
-        }
+void onResponseTimer(void *arg) {
+    ((ObdEcu *)arg)->onTimer(OBD_TIMER_RESPONSE);
+}
+
+void setupEcus() {
+    stateWriteMutex = xSemaphoreCreateMutex();
+    for (int i = 0; i < NUM_ECUS; i++) {
+        ObdEcu &ecu = ecus[i];
+        EcuPlatform &platform = ecu_platform[i];
+        platform.mutex = xSemaphoreCreateMutex();
+
+        esp_timer_create_args_t timer_args = {};
+        timer_args.arg = &ecu;
+        timer_args.callback = onIsoTpTimer;
+        timer_args.name = "isotp";
+        esp_timer_create(&timer_args, &platform.timers[OBD_TIMER_ISOTP]);
+
+        timer_args.callback = onResponseTimer;
+        timer_args.name = "ecu_resp";
+        esp_timer_create(&timer_args, &platform.timers[OBD_TIMER_RESPONSE]);
+
+        ecu.begin(obd_hal, i);
+        Serial.printf("Virtual ECU %s: request 0x%03lX, response 0x%03lX%s\n", ecu.config.name,
+                      (unsigned long)rawCanId(ecu.config.request_id), (unsigned long)rawCanId(ecu.config.response_id),
+                      isExtendedCanId(ecu.config.request_id) ? " (29-bit)" : "");
     }
+    refreshResponseCache(vehicle.read());
 }
 
-void sendSupportedPids_09(byte pid) {
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8;
-    tx_frame.extd = 0;
-    
-    // Announce support for PIDs 01-20 in service 09
-    // We support 0x02 (VIN), 0x04 (CAL ID), 0x06 (CVN)
-    uint32_t supported_pids = 0;
-    supported_pids |= (1UL << (32 - 0x02)); // VIN
-    supported_pids |= (1UL << (32 - 0x04)); // CAL ID
-    supported_pids |= (1UL << (32 - 0x06)); // CVN
-    
-    tx_frame.data[0] = 6; // Length: 1 (service) + 1 (PID) + 4 (data)
-    tx_frame.data_length_code = 1 + 6;
-    tx_frame.data[1] = 0x49; // Response to service 09
-    tx_frame.data[2] = pid;  // PID 0x00
-    tx_frame.data[3] = (supported_pids >> 24) & 0xFF; // MSB
-    tx_frame.data[4] = (supported_pids >> 16) & 0xFF;
-    tx_frame.data[5] = (supported_pids >> 8) & 0xFF;
-    tx_frame.data[6] = supported_pids & 0xFF;        // LSB
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent Supported PIDs [09/01-20] data");
-}
-
-void sendCalId(byte pid) {
-    // CAL ID is up to 16 bytes. Total data length = 1 (service) + 1 (PID) + 16 = 18 bytes.
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8;
-    tx_frame.extd = 0;
-    tx_frame.data_length_code = 8;
-
-    // --- First Frame (FF) ---
-    const int total_data_len = 1 + 1 + strlen(cal_id);
-    tx_frame.data[0] = 0x10 | ((total_data_len >> 8) & 0x0F); // PCI: First Frame
-    tx_frame.data[1] = total_data_len & 0xFF;                 // PCI: Length
-    tx_frame.data[2] = 0x49; // Response to service 09
-    tx_frame.data[3] = pid;  // PID 0x04
-    
-    // Copy first part of CAL ID
-    memcpy(&tx_frame.data[4], cal_id, 4);
-    
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent CAL ID FF");
-
-    // Start state machine for CFs
-    isoTpState = ISOTP_SEND_CALID_CF1;
-    isoTpNextTime = millis() + ISOTP_DELAY_MS;
-}
-
-void sendCvn(byte pid) {
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8;
-    tx_frame.extd = 0;
-    tx_frame.data_length_code = 8;
-
-    tx_frame.data[0] = 1 + 1 + 4; // Length: 1 (service) + 1 (PID) + 4 (CVN)
-    tx_frame.data[1] = 0x49;      // Response to service 09
-    tx_frame.data[2] = pid;       // PID 0x06
-
-    // Convert CVN hex string to bytes
-    long cvn_val = strtol(cvn, NULL, 16);
-    tx_frame.data[3] = (cvn_val >> 24) & 0xFF;
-    tx_frame.data[4] = (cvn_val >> 16) & 0xFF;
-    tx_frame.data[5] = (cvn_val >> 8) & 0xFF;
-    tx_frame.data[6] = cvn_val & 0xFF;
-    tx_frame.data[7] = 0xAA; // Padding
-
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent CVN data (single frame).");
-}
-
-void sendDTCs() {
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8; // OBD_CAN_ID_RESPONSE;
-    tx_frame.extd = 0;
-
-    byte dtc_bytes[10]; // Max 5 DTCs * 2 bytes each
-    int byte_count = 0;
-    for(int i=0; i<num_dtcs && i < 5; i++) {
-        char p_code_char = dtcs[i][0];
-        int code_val = atoi(&dtcs[i][1]);
-        byte b1 = highByte(code_val);
-        byte b2 = lowByte(code_val);
-        if (p_code_char == 'P') b1 |= 0x00;
-        else if (p_code_char == 'C') b1 |= 0x40;
-        else if (p_code_char == 'B') b1 |= 0x80;
-        else if (p_code_char == 'U') b1 |= 0xC0;
-        
-        dtc_bytes[byte_count++] = b1;
-        dtc_bytes[byte_count++] = b2;
-    }
-
-    tx_frame.data[0] = 2 + byte_count; // Length: 1 (service) + 1 (num_dtcs) + byte_count
-    tx_frame.data[1] = 0x43; // Response to service 03
-    tx_frame.data[2] = num_dtcs;
-    memcpy(&tx_frame.data[3], dtc_bytes, byte_count);
-    tx_frame.data_length_code = 3 + byte_count;
-    
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent DTCs");
-}
-
-void sendPermanentDTCs() {
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8; // OBD_CAN_ID_RESPONSE;
-    tx_frame.extd = 0;
-
-    byte dtc_bytes[10]; // Max 5 DTCs * 2 bytes each
-    int byte_count = 0;
-    // Використовуємо список постійних помилок
-    for(int i=0; i<num_permanent_dtcs && i < 5; i++) {
-        char p_code_char = permanent_dtcs[i][0];
-        int code_val = atoi(&permanent_dtcs[i][1]);
-        byte b1 = highByte(code_val);
-        byte b2 = lowByte(code_val);
-        if (p_code_char == 'P') b1 |= 0x00;
-        else if (p_code_char == 'C') b1 |= 0x40;
-        else if (p_code_char == 'B') b1 |= 0x80;
-        else if (p_code_char == 'U') b1 |= 0xC0;
-        
-        dtc_bytes[byte_count++] = b1;
-        dtc_bytes[byte_count++] = b2;
-    }
-
-    tx_frame.data[0] = 2 + byte_count; // Length: 1 (service) + 1 (num_dtcs) + byte_count
-    tx_frame.data[1] = 0x4A; // Відповідь на сервіс 0A
-    tx_frame.data[2] = num_permanent_dtcs;
-    memcpy(&tx_frame.data[3], dtc_bytes, byte_count);
-    tx_frame.data_length_code = 3 + byte_count;
-    
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent Permanent DTCs");
+// Змінює стан автомобіля: копія опублікованого знімка -> modify -> нова версія.
+// Записувачі (веб-обробники, симуляція, сервіс 04) серіалізуються stateWriteMutex,
+// читачі бачать або старий, або новий знімок повністю.
+template <typename Fn>
+void updateVehicleState(Fn modify) {
+    xSemaphoreTake(stateWriteMutex, portMAX_DELAY);
+    VehicleState s = vehicle.read();
+    modify(s);
+    s.version++;
+    vehicle.write(s);
+    refreshResponseCache(s);
+    xSemaphoreGive(stateWriteMutex);
 }
 
-void clearDTCs() {
-    Serial.println("Received request to clear DTCs (Service 04).");
-    
-    // Скидаємо коди помилок
-    num_dtcs = 0;
-    for(int i=0; i<5; i++) {
-        dtcs[i][0] = '\0';
-    }
-
-    // Скидаємо лічильник пробігу з помилкою
-    distance_with_mil = 0;
-
-    // Надсилаємо позитивну відповідь для сервісу 04
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8; // OBD_CAN_ID_RESPONSE
-    tx_frame.extd = 0;
-    tx_frame.data_length_code = 2;
-    tx_frame.data[0] = 0x01; // Довжина відповіді
-    tx_frame.data[1] = 0x44; // Позитивна відповідь на сервіс 04
-    // Заповнюємо решту нулями
-    for(int i=2; i<8; i++) tx_frame.data[i] = 0x00;
-
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent Service 04 positive response. DTCs cleared.");
-
-    // Оновлюємо дисплей, щоб показати відсутність помилок
-    updateDisplay();
-    notifyClients();
-}
-
-void sendVIN(byte pid) {
-    // Повна реалізація передачі VIN за протоколом ISO-TP (багатокадрові повідомлення)
-    twai_message_t tx_frame;
-    memset(&tx_frame, 0, sizeof(tx_frame));
-    tx_frame.identifier = 0x7E8; // OBD_CAN_ID_RESPONSE;
-    tx_frame.extd = 0;
-    tx_frame.data_length_code = 8;
-
-    // --- First Frame (FF) ---
-    // Загальна довжина даних = 1 (сервіс) + 1 (PID) + 17 (VIN) = 19 байт
-    const int total_data_len = 19;
-    tx_frame.data[0] = 0x10 | ((total_data_len >> 8) & 0x0F); // PCI: First Frame
-    tx_frame.data[1] = total_data_len & 0xFF;                 // PCI: Довжина
-    tx_frame.data[2] = 0x40 + 0x09; // Відповідь на сервіс 09
-    tx_frame.data[3] = pid;         // PID 0x02
-    tx_frame.data[4] = vin[0];
-    tx_frame.data[5] = vin[1];
-    tx_frame.data[6] = vin[2];
-    tx_frame.data[7] = vin[3];
-    twai_transmit(&tx_frame, portMAX_DELAY);
-    Serial.println("Sent VIN FF");
-
-    // Ініціалізуємо машину станів для відправки наступних кадрів без блокування
-    isoTpState = ISOTP_SEND_VIN_CF1;
-    isoTpNextTime = millis() + ISOTP_DELAY_MS;
-}
-
-void processIsoTp() {
-    if (isoTpState == ISOTP_IDLE) return;
-
-    if (millis() >= isoTpNextTime) {
-        twai_message_t tx_frame;
-        memset(&tx_frame, 0, sizeof(tx_frame));
-        tx_frame.identifier = 0x7E8;
-        tx_frame.extd = 0;
-        tx_frame.data_length_code = 8;
-
-        switch (isoTpState) {
-            case ISOTP_SEND_VIN_CF1: {
-                byte sequence_number = 1;
-                tx_frame.data[0] = 0x20 | sequence_number; // PCI: Consecutive Frame, SN=1
-                memcpy(&tx_frame.data[1], &vin[4], 7);
-                twai_transmit(&tx_frame, portMAX_DELAY);
-                Serial.println("Sent VIN CF1");
-                
-                isoTpState = ISOTP_SEND_VIN_CF2;
-                isoTpNextTime = millis() + ISOTP_DELAY_MS;
-                break;
-            }
-            case ISOTP_SEND_VIN_CF2: {
-                byte sequence_number = 2;
-                tx_frame.data[0] = 0x20 | sequence_number; // PCI: Consecutive Frame, SN=2
-                memcpy(&tx_frame.data[1], &vin[11], 6);
-                tx_frame.data[7] = 0xAA; // Padding
-                twai_transmit(&tx_frame, portMAX_DELAY);
-                Serial.println("Sent VIN CF2");
-                Serial.println("Sent full VIN via ISO-TP.");
-                
-                isoTpState = ISOTP_IDLE;
-                break;
-            }
-            case ISOTP_SEND_CALID_CF1: {
-                byte sequence_number = 1;
-                tx_frame.data[0] = 0x20 | sequence_number;
-                memcpy(&tx_frame.data[1], &cal_id[4], 7);
-                twai_transmit(&tx_frame, portMAX_DELAY);
-                Serial.println("Sent CAL ID CF1");
-
-                isoTpState = ISOTP_SEND_CALID_CF2;
-                isoTpNextTime = millis() + ISOTP_DELAY_MS;
-                break;
-            }
-            case ISOTP_SEND_CALID_CF2: {
-                byte sequence_number = 2;
-                tx_frame.data[0] = 0x20 | sequence_number;
-                int remaining = strlen(cal_id) - 11;
-                if (remaining > 0) memcpy(&tx_frame.data[1], &cal_id[11], remaining);
-                for (int i = 1 + remaining; i < 8; i++) tx_frame.data[i] = 0xAA;
-                twai_transmit(&tx_frame, portMAX_DELAY);
-                Serial.println("Sent CAL ID CF2");
-                Serial.println("Sent full CAL ID via ISO-TP.");
-
-                isoTpState = ISOTP_IDLE;
-                break;
-            }
-        }
+// Перекодовує кеш відповідей усіх ECU з нового знімка стану.
+// Викликається лише з updateVehicleState() (або під час старту), тож записувач один.
+void refreshResponseCache(const VehicleState &s) {
+    for (ObdEcu &ecu : ecus) {
+        ecu.rebuildCache(s);
     }
-}
\ No newline at end of file
+}
+
+// Сервіс 04 для ECU з owns_dtcs і кнопка "Clear DTC" у веб-інтерфейсі.
+void clearStoredDtcs() {
+    updateVehicleState([](VehicleState &s) { clearCurrentDtcs(s); });
+    // Оновлюємо дисплей, щоб показати відсутність помилок (у loop(), не на CAN-шляху)
+    requestUiRefresh();
+}
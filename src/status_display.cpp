@@ -0,0 +1,153 @@
+#include "status_display.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+struct CellLayout {
+    uint8_t col;
+    uint8_t row;
+    uint8_t width; // Символів
+};
+
+// Порядок - як у StatusDisplay::Cell
+const CellLayout CELLS[] = {
+    {5, 1, 17},  // VIN
+    {5, 3, 9},   // RPM
+    {21, 3, 5},  // Speed
+    {6, 4, 8},   // Temp
+    {19, 4, 7},  // MAF
+    {6, 5, 8},   // Fuel
+    {20, 5, 6},  // Volt
+    {8, 6, 6},   // MIL km
+    {19, 6, 7},  // Cyc
+    {0, 9, 26},  // DTC 1-4
+    {0, 10, 26}, // DTC 5
+};
+
+struct Label {
+    uint8_t col;
+    uint8_t row;
+    uint16_t color;
+    const char *text;
+};
+
+const Label LABELS[] = {
+    {0, 0, ST7735_YELLOW, "OBD-II EMULATOR STATUS"},
+    {0, 1, ST7735_WHITE, "VIN:"},
+    {0, 3, ST7735_WHITE, "RPM:"},
+    {14, 3, ST7735_WHITE, "Speed:"},
+    {0, 4, ST7735_WHITE, "Temp:"},
+    {14, 4, ST7735_WHITE, "MAF:"},
+    {0, 5, ST7735_WHITE, "Fuel:"},
+    {14, 5, ST7735_WHITE, "Volt:"},
+    {0, 6, ST7735_WHITE, "MIL km:"},
+    {14, 6, ST7735_WHITE, "Cyc:"},
+    {0, 8, ST7735_WHITE, "DTCs:"},
+};
+
+// Коди з first по first + count - 1 через пробіл
+void formatDtcs(const VehicleState &s, int first, int count, char *out, size_t size) {
+    out[0] = '\0';
+    size_t len = 0;
+    for (int i = first; i < first + count && i < s.num_dtcs; i++) {
+        len += snprintf(out + len, size - len, "%s ", s.dtcs[i]);
+        if (len >= size) break;
+    }
+}
+
+} // namespace
+
+bool StatusDisplay::begin() {
+    if (!frame_) {
+        frame_ = new GFXcanvas16(WIDTH, HEIGHT);
+        if (!frame_->getBuffer()) { // Adafruit_GFX не кидає винятків - лише порожній буфер
+            delete frame_;
+            frame_ = nullptr;
+            return false;
+        }
+        frame_->setTextSize(1);
+        frame_->setTextWrap(false);
+    }
+    return true;
+}
+
+void StatusDisplay::render(const VehicleState &s) {
+    if (!frame_) return;
+    if (!layoutDrawn_) drawLayout();
+
+    char text[NUM_CELLS][COLUMNS + 1];
+    snprintf(text[CELL_VIN], COLUMNS + 1, "%s", s.vin);
+    snprintf(text[CELL_RPM], COLUMNS + 1, "%d", s.engine_rpm);
+    snprintf(text[CELL_SPEED], COLUMNS + 1, "%d", s.vehicle_speed);
+    snprintf(text[CELL_TEMP], COLUMNS + 1, "%dC", s.engine_temp);
+    snprintf(text[CELL_MAF], COLUMNS + 1, "%.1f", s.maf_rate);
+    snprintf(text[CELL_FUEL], COLUMNS + 1, "%.0f%%", s.fuel_level);
+    snprintf(text[CELL_VOLTAGE], COLUMNS + 1, "%.1f", s.battery_voltage);
+    snprintf(text[CELL_DIST_MIL], COLUMNS + 1, "%d", s.distance_with_mil);
+    snprintf(text[CELL_CYCLES], COLUMNS + 1, "%d/%d", s.error_free_cycles, CYCLES_THRESHOLD);
+    uint16_t dtc_color = ST7735_RED;
+    if (s.num_dtcs > 0) {
+        formatDtcs(s, 0, 4, text[CELL_DTCS_1], COLUMNS + 1); // 4 x "P0300 " = 24 символи
+        formatDtcs(s, 4, MAX_DTCS - 4, text[CELL_DTCS_2], COLUMNS + 1);
+    } else {
+        dtc_color = ST7735_GREEN;
+        snprintf(text[CELL_DTCS_1], COLUMNS + 1, "  None");
+        text[CELL_DTCS_2][0] = '\0';
+    }
+
+    for (int i = 0; i < NUM_CELLS; i++) {
+        const uint16_t color = (i == CELL_DTCS_1 || i == CELL_DTCS_2) ? dtc_color : ST7735_WHITE;
+        if (color == color_[i] && strcmp(text[i], text_[i]) == 0) continue;
+        drawCell(i, text[i], color);
+        strcpy(text_[i], text[i]);
+        color_[i] = color;
+    }
+}
+
+// Розмітка без значень - у буфер і на панель цілим кадром
+void StatusDisplay::drawLayout() {
+    frame_->fillScreen(ST7735_BLACK);
+    for (const Label &label : LABELS) {
+        frame_->setCursor(label.col * CHAR_W, label.row * CHAR_H);
+        frame_->setTextColor(label.color);
+        frame_->print(label.text);
+    }
+    push(0, 0, WIDTH, HEIGHT);
+    // Клітинки порожні: render() намалює всі непорожні
+    memset(text_, 0, sizeof(text_));
+    for (uint16_t &color : color_) color = ST7735_BLACK;
+    layoutDrawn_ = true;
+}
+
+// Текст із фоном на всю ширину клітинки: старі символи затираються тим самим вікном
+void StatusDisplay::drawCell(int cell, const char *text, uint16_t color) {
+    const CellLayout &layout = CELLS[cell];
+    const int x = layout.col * CHAR_W;
+    const int y = layout.row * CHAR_H;
+    const int w = layout.width * CHAR_W;
+    char clipped[COLUMNS + 1];
+    snprintf(clipped, sizeof(clipped), "%.*s", layout.width, text); // Не заходимо на сусідні клітинки
+    frame_->fillRect(x, y, w, CHAR_H, ST7735_BLACK);
+    frame_->setCursor(x, y);
+    frame_->setTextColor(color);
+    frame_->print(clipped);
+    push(x, y, w, CHAR_H);
+}
+
+// Прямокутник буфера - одним вікном. Рядки повної ширини суцільні в пам'яті й
+// ідуть однією передачею (DMA, якщо Adafruit_SPITFT підтримує його на платформі),
+// вужчі - по рядку.
+void StatusDisplay::push(int x, int y, int w, int h) {
+    uint16_t *pixels = frame_->getBuffer() + y * WIDTH + x;
+    tft_.startWrite();
+    tft_.setAddrWindow(x, y, w, h);
+    if (w == WIDTH) {
+        tft_.writePixels(pixels, (uint32_t)w * h, false);
+        tft_.dmaWait(); // Буфер можна змінювати лише після завершення передачі
+    } else {
+        for (int row = 0; row < h; row++) tft_.writePixels(pixels + row * WIDTH, w);
+    }
+    tft_.endWrite();
+}
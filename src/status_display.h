@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_ST7735.h>
+
+#include "vehicle_state.h"
+
+// ############## Екран стану (ST7735 160x128, шрифт 6x8) ##############
+// Розмітка - сітка 26x16 символів. Увесь кадр малюється в позаекранний буфер
+// RGB565 (40 КБ), на панель передаються лише змінені ділянки: заголовок і підписи
+// - один раз, далі - клітинки значень, текст або колір яких змінився. Клітинка має
+// фіксовану ширину (хвіст доповнюється фоном) і йде на панель одним вікном SPI.
+// Не потокобезпечний: панеллю та буфером володіє одна задача (displayTask у main.cpp).
+class StatusDisplay {
+public:
+    static const int WIDTH = 160;
+    static const int HEIGHT = 128;
+    static const int COLUMNS = 26;
+
+    explicit StatusDisplay(Adafruit_ST7735 &tft) : tft_(tft) {}
+
+    // Виділяє буфер кадру; false - немає пам'яті, render() нічого не робить.
+    bool begin();
+
+    // Перший виклик (і перший після invalidate()) малює весь екран.
+    void render(const VehicleState &s);
+    void invalidate() { layoutDrawn_ = false; }
+
+private:
+    static const int CHAR_W = 6;
+    static const int CHAR_H = 8;
+
+    enum Cell {
+        CELL_VIN, CELL_RPM, CELL_SPEED, CELL_TEMP, CELL_MAF, CELL_FUEL,
+        CELL_VOLTAGE, CELL_DIST_MIL, CELL_CYCLES, CELL_DTCS_1, CELL_DTCS_2,
+        NUM_CELLS
+    };
+
+    void drawLayout();
+    void drawCell(int cell, const char *text, uint16_t color);
+    void push(int x, int y, int w, int h);
+
+    Adafruit_ST7735 &tft_;
+    GFXcanvas16 *frame_ = nullptr;
+    bool layoutDrawn_ = false;
+    char text_[NUM_CELLS][COLUMNS + 1] = {};
+    uint16_t color_[NUM_CELLS] = {};
+};
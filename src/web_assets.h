@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// ############## Веб-інтерфейс: стиснуті файли ##############
+// Джерела - web/ (HTML, JS, CSS). scripts/build_web.py мінімізує їх і стискає
+// в data/<файл>.gz: на ESP32 це образ LittleFS (pio run -t uploadfs), Linux-збірка
+// читає каталог data/ напряму. Файли віддаються як є з Content-Encoding: gzip та
+// сильним ETag від вмісту; браузер перевіряє їх (Cache-Control: no-cache) і
+// отримує 304 без тіла, доки прошивку/образ не оновили.
+struct WebAsset {
+    const char *url;
+    const char *path;         // Шлях у файловій системі, без .gz
+    const char *content_type;
+};
+
+const WebAsset WEB_ASSETS[] = {
+    {"/",          "/index.html", "text/html; charset=utf-8"},
+    {"/app.js",    "/app.js",     "application/javascript; charset=utf-8"},
+    {"/style.css", "/style.css",  "text/css; charset=utf-8"},
+};
+const size_t NUM_WEB_ASSETS = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);
+
+const size_t WEB_ETAG_SIZE = 24; // "xxxxxxxx-xxxxxxxx" + лапки + '\0'
+const char WEB_CACHE_CONTROL[] = "no-cache";
+
+// FNV-1a: файл читається блоками, хеш накопичується між викликами
+inline uint32_t webAssetHash(const uint8_t *data, size_t len, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Сильний ETag (RFC 7232) з хешу та розміру стиснутого файлу
+inline void formatWebEtag(uint32_t hash, size_t size, char *out) {
+    snprintf(out, WEB_ETAG_SIZE, "\"%08lx-%lx\"", (unsigned long)hash, (unsigned long)size);
+}
+
+// If-None-Match: "*" або список ETag через кому (можливо з W/ - для GET порівняння слабке)
+inline bool webEtagMatches(const char *if_none_match, const char *etag) {
+    if (!if_none_match || !etag[0]) return false;
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != nullptr;
+}
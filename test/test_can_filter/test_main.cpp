@@ -0,0 +1,63 @@
+#include <unity.h>
+
+#include "can_filter.h"
+
+// Емуляція апаратного фільтра TWAI для 11-бітних кадрів даних (RTR = 0).
+static bool acceptsStd(const AcceptanceFilter &f, uint32_t id) {
+    if (f.single_filter) {
+        uint32_t bits = id << 21;
+        return ((bits ^ f.acceptance_code) & ~f.acceptance_mask & 0xFFF00000UL) == 0;
+    }
+    uint32_t bits = id << 5;
+    bool first = ((bits ^ (f.acceptance_code >> 16)) & ~(f.acceptance_mask >> 16) & 0xFFF0) == 0;
+    bool second = ((bits ^ f.acceptance_code) & ~f.acceptance_mask & 0xFFF0) == 0;
+    return first || second;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_list_accepts_all() {
+    CanFilterPlan plan = planAcceptanceFilter(nullptr, 0);
+    TEST_ASSERT_EQUAL_HEX32(0, plan.config.acceptance_code);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, plan.config.acceptance_mask);
+    TEST_ASSERT_TRUE(plan.config.single_filter);
+}
+
+void test_ecm_and_tcm_filter_is_exact() {
+    const uint32_t ids[] = {0x7E0, 0x7DF, 0x7E1};
+    CanFilterPlan plan = planAcceptanceFilter(ids, 3);
+    TEST_ASSERT_TRUE(plan.exact);
+    TEST_ASSERT_EQUAL_UINT64(3, plan.accepted_ids);
+
+    int accepted = 0;
+    for (uint32_t id = 0; id <= CAN_STD_ID_MASK; id++) {
+        if (acceptsStd(plan.config, id)) accepted++;
+    }
+    TEST_ASSERT_EQUAL(3, accepted);
+    for (uint32_t id : ids) TEST_ASSERT_TRUE(acceptsStd(plan.config, id));
+}
+
+void test_all_physical_ids_pass() {
+    uint32_t ids[9] = {0x7DF};
+    for (int i = 0; i < 8; i++) ids[1 + i] = 0x7E0 + i;
+    CanFilterPlan plan = planAcceptanceFilter(ids, 9);
+    for (uint32_t id : ids) TEST_ASSERT_TRUE(acceptsStd(plan.config, id));
+    TEST_ASSERT_FALSE(acceptsStd(plan.config, 0x100));
+}
+
+void test_extended_ids_pass_as_superset() {
+    const uint32_t ids[] = {0x18DB33F1 | CAN_EXTENDED_FLAG, 0x18DA10F1 | CAN_EXTENDED_FLAG};
+    CanFilterPlan plan = planAcceptanceFilter(ids, 2);
+    TEST_ASSERT_TRUE(plan.accepted_ids >= 2);
+    TEST_ASSERT_TRUE(plan.accepted_ids < (1ULL << 29));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_list_accepts_all);
+    RUN_TEST(test_ecm_and_tcm_filter_is_exact);
+    RUN_TEST(test_all_physical_ids_pass);
+    RUN_TEST(test_extended_ids_pass_as_superset);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "can_recorder.h"
+
+static CanRecorder *recorder;
+static char line[CandumpStream::MAX_LINE];
+
+// Записи з масиву замість файлу
+class ArraySource : public CanRecordSource {
+public:
+    ArraySource(const CanRecord *records, size_t count) : records_(records), count_(count) {}
+    bool next(CanRecord &record) override {
+        if (pos_ == count_) return false;
+        record = records_[pos_++];
+        return true;
+    }
+
+private:
+    const CanRecord *records_;
+    size_t count_;
+    size_t pos_ = 0;
+};
+
+static CanFrame frame(uint32_t id, uint8_t dlc, const uint8_t *data) {
+    CanFrame f = {};
+    f.id = id;
+    f.dlc = dlc;
+    memcpy(f.data, data, dlc);
+    return f;
+}
+
+void setUp() {
+    recorder = new CanRecorder();
+}
+
+void tearDown() {
+    delete recorder;
+}
+
+void test_records_only_while_recording() {
+    const uint8_t data[] = {0x02, 0x01, 0x0C};
+    TEST_ASSERT_FALSE(recorder->record(frame(0x7DF, 3, data), 10, false));
+    recorder->start();
+    TEST_ASSERT_TRUE(recorder->record(frame(0x7DF, 3, data), 1234567, false));
+    TEST_ASSERT_TRUE(recorder->record(frame(0x7E8, 3, data), 1234999, true));
+    recorder->stop();
+    TEST_ASSERT_FALSE(recorder->record(frame(0x7DF, 3, data), 1235000, false));
+
+    CanRecord r;
+    TEST_ASSERT_TRUE(recorder->pop(r));
+    TEST_ASSERT_EQUAL_UINT64(1234567, r.timestamp_us);
+    TEST_ASSERT_EQUAL_HEX32(0x7DF, r.id);
+    TEST_ASSERT_EQUAL(0, r.flags);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, r.data, 3);
+    TEST_ASSERT_TRUE(recorder->pop(r));
+    TEST_ASSERT_EQUAL(CAN_RECORD_TX, r.flags);
+    TEST_ASSERT_FALSE(recorder->pop(r));
+}
+
+void test_full_ring_drops_and_counts() {
+    const uint8_t data[] = {0};
+    recorder->start();
+    for (uint32_t i = 0; i < CanRecorder::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(recorder->record(frame(0x100, 1, data), i, false));
+    }
+    TEST_ASSERT_FALSE(recorder->record(frame(0x100, 1, data), 0, false));
+    TEST_ASSERT_EQUAL(1, recorder->takeDropped());
+    TEST_ASSERT_EQUAL(0, recorder->takeDropped());
+}
+
+void test_candump_line_format() {
+    const uint8_t data[] = {0x04, 0x41, 0x0C, 0x1A, 0xF8};
+    CanRecord r = {};
+    r.timestamp_us = 12345678;
+    r.id = 0x7E8;
+    r.dlc = 5;
+    memcpy(r.data, data, 5);
+    int len = formatCandumpLine(r, "can0", line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("(0000000012.345678) can0 7E8#04410C1AF8\n", line);
+    TEST_ASSERT_EQUAL(strlen(line), len);
+
+    r.id = 0x18DAF110 | CAN_EXTENDED_FLAG;
+    r.dlc = 0;
+    formatCandumpLine(r, "can0", line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("(0000000012.345678) can0 18DAF110#\n", line);
+}
+
+void test_stream_splits_lines_across_chunks() {
+    CanRecord records[3] = {};
+    for (int i = 0; i < 3; i++) {
+        records[i].timestamp_us = 1000000 * (i + 1);
+        records[i].id = 0x7DF;
+        records[i].dlc = 8;
+        memset(records[i].data, 0x10 * i, 8);
+    }
+    char expected[256] = "";
+    for (const CanRecord &r : records) {
+        formatCandumpLine(r, "can0", line, sizeof(line));
+        strcat(expected, line);
+    }
+
+    ArraySource source(records, 3);
+    CandumpStream stream(source, "can0");
+    char out[256] = "";
+    size_t total = 0;
+    size_t n;
+    while ((n = stream.read((uint8_t *)out + total, 7)) > 0) {
+        TEST_ASSERT_TRUE(n <= 7);
+        total += n;
+    }
+    TEST_ASSERT_EQUAL(strlen(expected), total);
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+}
+
+void test_empty_source_ends_stream() {
+    ArraySource source(nullptr, 0);
+    CandumpStream stream(source, "can0");
+    uint8_t buf[16];
+    TEST_ASSERT_EQUAL(0, stream.read(buf, sizeof(buf)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_only_while_recording);
+    RUN_TEST(test_full_ring_drops_and_counts);
+    RUN_TEST(test_candump_line_format);
+    RUN_TEST(test_stream_splits_lines_across_chunks);
+    RUN_TEST(test_empty_source_ends_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "isotp.h"
+
+// Передавач без таймерів: кадри складаються в масив, заведений таймер - у armed_delay.
+static CanFrame sent[64];
+static int sent_count;
+static uint32_t armed_delay;
+static bool transmit_ok;
+static IsoTpSender sender;
+
+static bool recordTransmit(void *, const CanFrame &frame) {
+    if (!transmit_ok) return false;
+    sent[sent_count++] = frame;
+    return true;
+}
+
+static void recordArmTimer(void *, uint32_t delay_us) {
+    armed_delay = delay_us;
+}
+
+void setUp() {
+    sent_count = 0;
+    armed_delay = 0;
+    transmit_ok = true;
+    IsoTpSender::Hooks hooks = {recordTransmit, recordArmTimer, nullptr};
+    sender.begin(0x7E8, hooks);
+}
+
+void tearDown() {}
+
+static void fillPayload(uint8_t *payload, size_t len) {
+    for (size_t i = 0; i < len; i++) payload[i] = (uint8_t)i;
+}
+
+void test_single_frame_is_sent_immediately() {
+    const uint8_t payload[] = {0x41, 0x0D, 0x3C};
+    TEST_ASSERT_TRUE(sender.send(payload, sizeof(payload), 0));
+    TEST_ASSERT_EQUAL(1, sent_count);
+    TEST_ASSERT_EQUAL_HEX32(0x7E8, sent[0].id);
+    TEST_ASSERT_EQUAL(4, sent[0].dlc);
+    TEST_ASSERT_EQUAL_HEX8(0x03, sent[0].data[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(payload, &sent[0].data[1], sizeof(payload));
+    TEST_ASSERT_FALSE(sender.busy());
+}
+
+void test_first_frame_waits_for_flow_control() {
+    uint8_t payload[19];
+    fillPayload(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(sender.send(payload, sizeof(payload), 0));
+    TEST_ASSERT_EQUAL(1, sent_count);
+    TEST_ASSERT_EQUAL_HEX8(0x10, sent[0].data[0]);
+    TEST_ASSERT_EQUAL_HEX8(19, sent[0].data[1]);
+    TEST_ASSERT_EQUAL_UINT32(IsoTpSender::N_BS_TIMEOUT_US, armed_delay);
+    TEST_ASSERT_TRUE(sender.busy());
+
+    // Друга передача не починається, поки триває перша
+    TEST_ASSERT_FALSE(sender.send(payload, sizeof(payload), 0));
+
+    const uint8_t fc[] = {0x30, 0x00, 0x00};
+    sender.onFlowControl(fc, sizeof(fc), 100);
+    TEST_ASSERT_EQUAL(3, sent_count);
+    TEST_ASSERT_EQUAL_HEX8(0x21, sent[1].data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x22, sent[2].data[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&payload[13], &sent[2].data[1], 6);
+    TEST_ASSERT_EQUAL_HEX8(IsoTpSender::PADDING, sent[2].data[7]);
+    TEST_ASSERT_FALSE(sender.busy());
+}
+
+void test_block_size_requests_next_flow_control() {
+    uint8_t payload[40];
+    fillPayload(payload, sizeof(payload));
+    sender.send(payload, sizeof(payload), 0);
+
+    const uint8_t fc[] = {0x30, 0x02, 0x00};
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_EQUAL(3, sent_count); // FF + 2 CF
+    TEST_ASSERT_TRUE(sender.busy());
+
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_EQUAL(5, sent_count);
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_EQUAL(6, sent_count); // 6 + 5 * 7 >= 40
+    TEST_ASSERT_FALSE(sender.busy());
+}
+
+void test_st_min_paces_consecutive_frames() {
+    uint8_t payload[20];
+    fillPayload(payload, sizeof(payload));
+    sender.send(payload, sizeof(payload), 0);
+
+    const uint8_t fc[] = {0x30, 0x00, 0x05}; // 5 мс
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_EQUAL(2, sent_count);
+    TEST_ASSERT_EQUAL_UINT32(5000, armed_delay);
+
+    sender.onTimer(4999); // Ще зарано
+    TEST_ASSERT_EQUAL(2, sent_count);
+    sender.onTimer(5000);
+    TEST_ASSERT_EQUAL(3, sent_count);
+    TEST_ASSERT_FALSE(sender.busy());
+}
+
+void test_missing_flow_control_aborts() {
+    uint8_t payload[10];
+    fillPayload(payload, sizeof(payload));
+    sender.send(payload, sizeof(payload), 0);
+    sender.onTimer(IsoTpSender::N_BS_TIMEOUT_US);
+    TEST_ASSERT_FALSE(sender.busy());
+
+    const uint8_t fc[] = {0x30, 0x00, 0x00};
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_EQUAL(1, sent_count);
+}
+
+void test_overflow_flow_status_aborts() {
+    uint8_t payload[10];
+    fillPayload(payload, sizeof(payload));
+    sender.send(payload, sizeof(payload), 0);
+    const uint8_t fc[] = {0x32, 0x00, 0x00};
+    sender.onFlowControl(fc, sizeof(fc), 0);
+    TEST_ASSERT_FALSE(sender.busy());
+    TEST_ASSERT_EQUAL(1, sent_count);
+}
+
+void test_decode_st_min() {
+    TEST_ASSERT_EQUAL_UINT32(0, IsoTpSender::decodeStMin(0x00));
+    TEST_ASSERT_EQUAL_UINT32(127000, IsoTpSender::decodeStMin(0x7F));
+    TEST_ASSERT_EQUAL_UINT32(100, IsoTpSender::decodeStMin(0xF1));
+    TEST_ASSERT_EQUAL_UINT32(900, IsoTpSender::decodeStMin(0xF9));
+    TEST_ASSERT_EQUAL_UINT32(127000, IsoTpSender::decodeStMin(0x80)); // Зарезервовано
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_frame_is_sent_immediately);
+    RUN_TEST(test_first_frame_waits_for_flow_control);
+    RUN_TEST(test_block_size_requests_next_flow_control);
+    RUN_TEST(test_st_min_paces_consecutive_frames);
+    RUN_TEST(test_missing_flow_control_aborts);
+    RUN_TEST(test_overflow_flow_status_aborts);
+    RUN_TEST(test_decode_st_min);
+    return UNITY_END();
+}
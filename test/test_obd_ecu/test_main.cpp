@@ -0,0 +1,407 @@
+#include <unity.h>
+
+#include <initializer_list>
+#include <string.h>
+
+#include "obd_ecu.h"
+#include "service01_pids.h"
+#include "service06_monitors.h"
+#include "service09_info.h"
+
+// HAL без потоків і реального часу: час задає тест, таймери спрацьовують
+// лише через fireTimer(), передані кадри складаються в sent[].
+class FakeHal : public ObdHal {
+public:
+    uint32_t now_us = 0;
+    CanFrame sent[32];
+    uint8_t sent_priority[32];
+    int sent_count = 0;
+    uint32_t armed[2] = {0, 0}; // Затримка останнього armTimer, 0 - не заведено
+    int cleared = 0;
+    VehicleState state;
+
+    uint32_t micros() override { return now_us; }
+
+    bool transmit(const CanFrame &frame, uint8_t priority) override {
+        sent_priority[sent_count] = priority;
+        sent[sent_count++] = frame;
+        return true;
+    }
+
+    void armTimer(ObdEcu &, ObdTimer timer, uint32_t delay_us) override { armed[timer] = delay_us; }
+    void lock(ObdEcu &) override {}
+    void unlock(ObdEcu &) override {}
+    VehicleState readState() override { return state; }
+
+    void clearDtcs(ObdEcu &) override {
+        cleared++;
+        state.num_dtcs = 0;
+    }
+};
+
+static FakeHal hal;
+static ObdEcu ecus[] = {
+    ObdEcuConfig{"ECM", 0x7E0, 0x7E8, &SERVICE01, &SERVICE02, &SERVICE06, 0, true, &SERVICE09},
+    ObdEcuConfig{"TCM", 0x7E1, 0x7E9, &TCM_SERVICE01, nullptr, nullptr, 3000, false, &TCM_SERVICE09},
+};
+static const size_t NUM_ECUS = sizeof(ecus) / sizeof(ecus[0]);
+
+static void fireTimer(ObdEcu &ecu, ObdTimer timer) {
+    hal.now_us += hal.armed[timer];
+    hal.armed[timer] = 0;
+    ecu.onTimer(timer);
+}
+
+static CanFrame request(uint32_t id, std::initializer_list<uint8_t> bytes) {
+    CanFrame frame = {};
+    frame.id = id;
+    frame.dlc = 8;
+    frame.data[0] = bytes.size();
+    uint8_t i = 1;
+    for (uint8_t b : bytes) frame.data[i++] = b;
+    return frame;
+}
+
+static void dispatch(const CanFrame &frame) {
+    dispatchObdFrame(ecus, NUM_ECUS, frame, hal.now_us);
+}
+
+void setUp() {
+    hal = FakeHal();
+    hal.state.engine_rpm = 3000;
+    hal.state.vehicle_speed = 88;
+    strcpy(hal.state.vin, "1HGCM82633A004352");
+    strcpy(hal.state.dtcs[0], "P0300");
+    hal.state.num_dtcs = 1;
+    for (size_t i = 0; i < NUM_ECUS; i++) {
+        ecus[i].begin(hal, i);
+        ecus[i].rebuildCache(hal.state);
+    }
+}
+
+void tearDown() {}
+
+void test_single_pid_comes_from_cache() {
+    dispatch(request(0x7E0, {0x01, 0x0C}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    TEST_ASSERT_EQUAL_HEX32(0x7E8, hal.sent[0].id);
+    const uint8_t expected[] = {0x04, 0x41, 0x0C, 0x2E, 0xE0}; // 3000 * 4
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+}
+
+void test_unsupported_pid_is_ignored() {
+    dispatch(request(0x7E0, {0x01, 0x02}));
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+}
+
+void test_multiple_pids_skip_unsupported() {
+    dispatch(request(0x7E0, {0x01, 0x0D, 0x02, 0x05}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    const uint8_t expected[] = {0x05, 0x41, 0x0D, 88, 0x05, 90 + 40};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+}
+
+void test_supported_pids_mask_is_built_from_table() {
+    dispatch(request(0x7E1, {0x01, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    // TCM: 0x01, 0x0D та 0x20 (наступний діапазон, бо є 0xA4)
+    const uint8_t expected[] = {0x06, 0x41, 0x00, 0x80, 0x08, 0x00, 0x01};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+}
+
+void test_functional_request_delays_tcm() {
+    dispatch(request(OBD_FUNCTIONAL_ID, {0x01, 0x0D}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count); // ECM - одразу
+    TEST_ASSERT_EQUAL_HEX32(0x7E8, hal.sent[0].id);
+    TEST_ASSERT_EQUAL_UINT32(3000, hal.armed[OBD_TIMER_RESPONSE]);
+
+    fireTimer(ecus[1], OBD_TIMER_RESPONSE);
+    TEST_ASSERT_EQUAL(2, hal.sent_count);
+    TEST_ASSERT_EQUAL_HEX32(0x7E9, hal.sent[1].id);
+    TEST_ASSERT_EQUAL(1, hal.sent_priority[1]);
+}
+
+void test_other_ids_are_ignored() {
+    dispatch(request(0x7E2, {0x01, 0x0D}));
+    dispatch(request(0x7E0 | CAN_EXTENDED_FLAG, {0x01, 0x0D}));
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+}
+
+void test_service03_reports_dtcs_only_for_owner() {
+    dispatch(request(0x7E0, {0x03}));
+    dispatch(request(0x7E1, {0x03}));
+    TEST_ASSERT_EQUAL(2, hal.sent_count);
+    const uint8_t ecm[] = {0x04, 0x43, 0x01, 0x03, 0x00}; // P0300
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(ecm, hal.sent[0].data, sizeof(ecm));
+    const uint8_t tcm[] = {0x02, 0x43, 0x00};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(tcm, hal.sent[1].data, sizeof(tcm));
+}
+
+void test_service04_clears_through_hal() {
+    dispatch(request(0x7E0, {0x04}));
+    TEST_ASSERT_EQUAL(1, hal.cleared);
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    TEST_ASSERT_EQUAL_HEX8(0x44, hal.sent[0].data[1]);
+
+    dispatch(request(0x7E1, {0x04})); // TCM відповідає, але стан не чіпає
+    TEST_ASSERT_EQUAL(1, hal.cleared);
+    TEST_ASSERT_EQUAL(2, hal.sent_count);
+}
+
+static void sendFlowControl(uint32_t id) {
+    CanFrame fc = {};
+    fc.id = id;
+    fc.dlc = 3;
+    fc.data[0] = 0x30;
+    dispatch(fc);
+}
+
+// Збирає ISO-TP payload з First Frame та Consecutive Frames, починаючи з sent[first]
+static size_t reassemble(int first, uint8_t *out) {
+    const CanFrame &ff = hal.sent[first];
+    if ((ff.data[0] & 0xF0) == 0x00) {
+        memcpy(out, &ff.data[1], ff.data[0]);
+        return ff.data[0];
+    }
+    size_t total = ((ff.data[0] & 0x0F) << 8) | ff.data[1];
+    size_t len = 6;
+    memcpy(out, &ff.data[2], 6);
+    for (int i = first + 1; i < hal.sent_count && len < total; i++) {
+        size_t chunk = total - len < 7 ? total - len : 7;
+        memcpy(out + len, &hal.sent[i].data[1], chunk);
+        len += chunk;
+    }
+    return len;
+}
+
+void test_vin_uses_multi_frame() {
+    dispatch(request(0x7E0, {0x09, 0x02}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    TEST_ASSERT_EQUAL_HEX8(0x10, hal.sent[0].data[0]);
+    TEST_ASSERT_EQUAL_HEX8(20, hal.sent[0].data[1]); // 0x49 0x02 NODI + 17
+    TEST_ASSERT_TRUE(hal.armed[OBD_TIMER_ISOTP] > 0);
+
+    sendFlowControl(0x7E0);
+    TEST_ASSERT_EQUAL(3, hal.sent_count);
+
+    uint8_t payload[MAX_INFO_RESPONSE];
+    TEST_ASSERT_EQUAL(20, reassemble(0, payload));
+    TEST_ASSERT_EQUAL_HEX8(0x01, payload[2]);
+    char vin[18] = {};
+    memcpy(vin, &payload[3], 17);
+    TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", vin);
+}
+
+void test_service09_without_info_type_is_ignored() {
+    dispatch(request(0x7E0, {0x09})); // Заповнювач 0x00 - не InfoType 00
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+}
+
+void test_service09_supported_info_types() {
+    dispatch(request(0x7E0, {0x09, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    // 0x01-0x0A та 0x0D; 0x0B - лише для дизеля
+    const uint8_t expected[] = {0x06, 0x49, 0x00, 0xFF, 0xC8, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+
+    dispatch(request(0x7E0, {0x09, 0x01}));
+    const uint8_t vin_count[] = {0x03, 0x49, 0x01, 0x05};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(vin_count, hal.sent[1].data, sizeof(vin_count));
+}
+
+void test_service09_reports_all_calibrations() {
+    strcpy(hal.state.cal_id, "CAL_FROM_WEB");
+    ecus[0].rebuildCache(hal.state);
+
+    dispatch(request(0x7E0, {0x09, 0x04}));
+    sendFlowControl(0x7E0);
+    uint8_t payload[MAX_INFO_RESPONSE];
+    TEST_ASSERT_EQUAL(3 + 2 * 16, reassemble(0, payload));
+    TEST_ASSERT_EQUAL_HEX8(2, payload[2]);
+    TEST_ASSERT_EQUAL_STRING("CAL_FROM_WEB", (const char *)&payload[3]); // Доповнено нулями
+    TEST_ASSERT_EQUAL_HEX8_ARRAY("EMU_ECM_BOOT_01", &payload[3 + 16], 15);
+
+    // CVN зі стану - 32-бітний hex, без обрізання до LONG_MAX
+    int first = hal.sent_count;
+    dispatch(request(0x7E0, {0x09, 0x06}));
+    sendFlowControl(0x7E0);
+    TEST_ASSERT_EQUAL(3 + 2 * 4, reassemble(first, payload));
+    const uint8_t cvns[] = {0x49, 0x06, 0x02, 0xA1, 0xB2, 0xC3, 0xD4, 0x5A, 0x3C, 0x0F, 0x11};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(cvns, payload, sizeof(cvns));
+}
+
+void test_service09_ipt_follows_driving_cycles() {
+    applyDrivingCycle(hal.state); // Є P0300 - умови рахуються, завершення - ні
+    ecus[0].rebuildCache(hal.state);
+
+    dispatch(request(0x7E0, {0x09, 0x08}));
+    sendFlowControl(0x7E0);
+    uint8_t payload[MAX_INFO_RESPONSE];
+    TEST_ASSERT_EQUAL(3 + 2 * IPT_COUNTERS, reassemble(0, payload));
+    TEST_ASSERT_EQUAL_HEX8(IPT_COUNTERS, payload[2]);
+    TEST_ASSERT_EQUAL(43, payload[3] << 8 | payload[4]);   // OBDCOND
+    TEST_ASSERT_EQUAL(38, payload[7] << 8 | payload[8]);   // CATCOMP1
+    TEST_ASSERT_EQUAL(43, payload[9] << 8 | payload[10]);  // CATCOND1
+    TEST_ASSERT_EQUAL(0, payload[13] << 8 | payload[14]);  // CATCOND2 - монітора немає
+}
+
+void test_vin_change_reaches_cache() {
+    strcpy(hal.state.vin, "WVWZZZ1JZXW000001");
+    ecus[0].rebuildCache(hal.state);
+    ecus[0].rebuildCache(hal.state); // Другий банк - копія вже серіалізованих відповідей
+
+    dispatch(request(0x7E0, {0x09, 0x02}));
+    sendFlowControl(0x7E0);
+    uint8_t payload[MAX_INFO_RESPONSE];
+    reassemble(0, payload);
+    char vin[18] = {};
+    memcpy(vin, &payload[3], 17);
+    TEST_ASSERT_EQUAL_STRING("WVWZZZ1JZXW000001", vin);
+}
+
+void test_tcm_reports_identity_without_vin() {
+    dispatch(request(0x7E1, {0x09, 0x02}));
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+
+    dispatch(request(0x7E1, {0x09, 0x0A}));
+    sendFlowControl(0x7E1);
+    uint8_t payload[MAX_INFO_RESPONSE];
+    TEST_ASSERT_EQUAL(3 + 20, reassemble(0, payload));
+    const uint8_t name[] = {0x49, 0x0A, 0x01, 'T', 'C', 'M', 0x00, '-', 'T', 'r', 'a', 'n', 's'};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(name, payload, sizeof(name));
+}
+
+void test_freeze_frame_is_captured_when_dtc_is_set() {
+    hal.state.engine_rpm = 3800;
+    hal.state.vehicle_speed = 120;
+    addDTC(hal.state, "P0171");
+    hal.state.engine_rpm = 900; // Поточні значення кадр уже не змінюють
+
+    dispatch(request(0x7E0, {0x02, 0x0C, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    const uint8_t rpm[] = {0x05, 0x42, 0x0C, 0x00, 0x3B, 0x60}; // 3800 * 4
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(rpm, hal.sent[0].data, sizeof(rpm));
+
+    // Дві пари вже не вміщаються в Single Frame: 0x42 + (02 00 P0171) + (0D 00 speed)
+    dispatch(request(0x7E0, {0x02, 0x02, 0x00, 0x0D, 0x00}));
+    TEST_ASSERT_EQUAL(2, hal.sent_count);
+    const uint8_t first[] = {0x10, 0x08, 0x42, 0x02, 0x00, 0x01, 0x71, 0x0D};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(first, hal.sent[1].data, sizeof(first));
+}
+
+void test_freeze_frame_without_capture() {
+    // PID 0x02 кадру 0 відповідає 0000, решта - мовчить
+    dispatch(request(0x7E0, {0x02, 0x0C, 0x00}));
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+    dispatch(request(0x7E0, {0x02, 0x02, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    const uint8_t expected[] = {0x05, 0x42, 0x02, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+
+    dispatch(request(0x7E1, {0x02, 0x02, 0x00})); // TCM сервіс 02 не підтримує
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+}
+
+class DtcListParams : public StateParams {
+public:
+    const char *list;
+    const char *get(const char *name) const override { return strcmp(name, "dtc_list") == 0 ? list : nullptr; }
+};
+
+void test_web_update_replaces_freeze_frame() {
+    addDTC(hal.state, "P0171");
+    DtcListParams params;
+    params.list = "P0420";
+    applyStateUpdate(hal.state, params);
+
+    // Кадр 0 належить новому коду, а не P0171
+    dispatch(request(0x7E0, {0x02, 0x02, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    const uint8_t expected[] = {0x05, 0x42, 0x02, 0x00, 0x04, 0x20};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+}
+
+void test_service04_clears_freeze_frames() {
+    addDTC(hal.state, "P0171");
+    TEST_ASSERT_EQUAL(1, hal.state.num_freeze_frames);
+    clearCurrentDtcs(hal.state);
+    TEST_ASSERT_EQUAL(0, hal.state.num_freeze_frames);
+    dispatch(request(0x7E0, {0x02, 0x0C, 0x00}));
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+}
+
+void test_service06_supported_mids() {
+    dispatch(request(0x7E0, {0x06, 0x00}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    // MID 0x01 та 0x20 (далі є 0x21)
+    const uint8_t expected[] = {0x06, 0x46, 0x00, 0x80, 0x00, 0x00, 0x01};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, hal.sent[0].data, sizeof(expected));
+
+    dispatch(request(0x7E0, {0x06, 0xC0})); // Після 0xA5 діапазонів немає
+    dispatch(request(0x7E1, {0x06, 0x00})); // TCM сервіс 06 не підтримує
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+}
+
+void test_service06_without_mid_is_ignored() {
+    dispatch(request(0x7E0, {0x06})); // Заповнювач 0x00 - не MID 00
+    TEST_ASSERT_EQUAL(0, hal.sent_count);
+}
+
+void test_service06_misfire_counts_follow_state() {
+    hal.state.misfire_simulation_enabled = true;
+    hal.state.engine_rpm = 4000; // 20 + 500 / 50 = 30 пропусків на циліндр
+    ecus[0].rebuildCache(hal.state);
+
+    // 0x46 + 2 записи по 9 байтів = 19 -> First Frame + 2 Consecutive Frames
+    dispatch(request(0x7E0, {0x06, 0xA2}));
+    TEST_ASSERT_EQUAL(1, hal.sent_count);
+    TEST_ASSERT_EQUAL_HEX8(0x10, hal.sent[0].data[0]);
+    TEST_ASSERT_EQUAL_HEX8(19, hal.sent[0].data[1]);
+    sendFlowControl(0x7E0);
+    TEST_ASSERT_EQUAL(3, hal.sent_count);
+
+    uint8_t payload[19];
+    memcpy(payload, &hal.sent[0].data[2], 6);
+    memcpy(payload + 6, &hal.sent[1].data[1], 7);
+    memcpy(payload + 13, &hal.sent[2].data[1], 6);
+    const uint8_t expected[] = {
+        0x46,
+        0xA2, 0x0B, 0x24, 0x00, 15, 0x00, 0x00, 0x00, 0x28, // EWMA
+        0xA2, 0x0C, 0x24, 0x00, 30, 0x00, 0x00, 0x00, 0x28, // Поточний цикл
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, payload, sizeof(expected));
+}
+
+void test_filter_covers_all_ecu_ids() {
+    CanFilterPlan plan = planEcuFilter(ecus, NUM_ECUS);
+    TEST_ASSERT_TRUE(plan.exact);
+    TEST_ASSERT_EQUAL_UINT64(3, plan.accepted_ids);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_pid_comes_from_cache);
+    RUN_TEST(test_unsupported_pid_is_ignored);
+    RUN_TEST(test_multiple_pids_skip_unsupported);
+    RUN_TEST(test_supported_pids_mask_is_built_from_table);
+    RUN_TEST(test_functional_request_delays_tcm);
+    RUN_TEST(test_other_ids_are_ignored);
+    RUN_TEST(test_service03_reports_dtcs_only_for_owner);
+    RUN_TEST(test_service04_clears_through_hal);
+    RUN_TEST(test_vin_uses_multi_frame);
+    RUN_TEST(test_service09_without_info_type_is_ignored);
+    RUN_TEST(test_service09_supported_info_types);
+    RUN_TEST(test_service09_reports_all_calibrations);
+    RUN_TEST(test_service09_ipt_follows_driving_cycles);
+    RUN_TEST(test_vin_change_reaches_cache);
+    RUN_TEST(test_tcm_reports_identity_without_vin);
+    RUN_TEST(test_freeze_frame_is_captured_when_dtc_is_set);
+    RUN_TEST(test_freeze_frame_without_capture);
+    RUN_TEST(test_web_update_replaces_freeze_frame);
+    RUN_TEST(test_service04_clears_freeze_frames);
+    RUN_TEST(test_service06_supported_mids);
+    RUN_TEST(test_service06_without_mid_is_ignored);
+    RUN_TEST(test_service06_misfire_counts_follow_state);
+    RUN_TEST(test_filter_covers_all_ecu_ids);
+    return UNITY_END();
+}
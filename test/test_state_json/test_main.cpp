@@ -0,0 +1,70 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "state_json.h"
+
+static VehicleState s;
+static VehicleState prev;
+static char json[STATE_JSON_MAX];
+
+void setUp() {
+    s = VehicleState();
+    prev = VehicleState();
+    memset(json, 0, sizeof(json));
+}
+
+void tearDown() {}
+
+void test_keyframe_has_all_fields() {
+    addDTC(s, "P0300");
+    size_t len = writeStateJson(s, nullptr, json, sizeof(json));
+    TEST_ASSERT_EQUAL(strlen(json), len);
+    TEST_ASSERT_EQUAL('{', json[0]);
+    TEST_ASSERT_EQUAL('}', json[len - 1]);
+    const char *keys[] = {"\"vin\":\"VIN_NOT_SET\"", "\"rpm\":1500", "\"maf\":10.00", "\"timing\":5.0",
+                          "\"voltage\":14.2", "\"dynamic_rpm\":false", "\"dtcs\":[\"P0300\"]",
+                          "\"permanent_dtcs\":[\"P0300\"]"};
+    for (const char *key : keys) TEST_ASSERT_NOT_NULL(strstr(json, key));
+}
+
+void test_delta_has_only_changed_fields() {
+    s.engine_rpm = 3200;
+    s.dynamic_rpm_enabled = true;
+    size_t len = writeStateJson(s, &prev, json, sizeof(json));
+    TEST_ASSERT_EQUAL(strlen(json), len);
+    TEST_ASSERT_EQUAL_STRING("{\"rpm\":3200,\"dynamic_rpm\":true}", json);
+}
+
+void test_unchanged_state_gives_no_delta() {
+    s.maf_rate = prev.maf_rate + 0.001f; // Сторінка показує 2 знаки - зміна непомітна
+    TEST_ASSERT_EQUAL(0, writeStateJson(s, &prev, json, sizeof(json)));
+}
+
+void test_dtc_list_change() {
+    addDTC(prev, "P0300");
+    addDTC(s, "P0171");
+    writeStateJson(s, &prev, json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"dtcs\":[\"P0171\"],\"permanent_dtcs\":[\"P0171\"]}", json);
+}
+
+void test_strings_are_escaped() {
+    strcpy(s.cal_id, "A\"B\\C\n");
+    writeStateJson(s, &prev, json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("{\"cal_id\":\"A\\\"B\\\\C\\u000a\"}", json);
+}
+
+void test_small_buffer_fails() {
+    TEST_ASSERT_EQUAL(0, writeStateJson(s, nullptr, json, 64));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_keyframe_has_all_fields);
+    RUN_TEST(test_delta_has_only_changed_fields);
+    RUN_TEST(test_unchanged_state_gives_no_delta);
+    RUN_TEST(test_dtc_list_change);
+    RUN_TEST(test_strings_are_escaped);
+    RUN_TEST(test_small_buffer_fails);
+    return UNITY_END();
+}
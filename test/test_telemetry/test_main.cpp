@@ -0,0 +1,81 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "telemetry.h"
+
+static VehicleState s;
+static uint8_t frame[TELEMETRY_FRAME_SIZE];
+
+static uint16_t u16(size_t offset) { return frame[offset] | (frame[offset + 1] << 8); }
+
+static float f32(size_t offset) {
+    float value;
+    memcpy(&value, &frame[offset], sizeof(value));
+    return value;
+}
+
+void setUp() {
+    s = VehicleState();
+    memset(frame, 0xAA, sizeof(frame));
+}
+
+void tearDown() {}
+
+void test_header_and_flags() {
+    s.version = 0x01020304;
+    s.misfire_simulation_enabled = true;
+    s.lean_mixture_simulation_enabled = true;
+    encodeTelemetry(s, frame);
+    TEST_ASSERT_EQUAL(TELEMETRY_SCHEMA, frame[0]);
+    TEST_ASSERT_EQUAL(TELEMETRY_MISFIRE_SIM | TELEMETRY_LEAN_MIXTURE_SIM, frame[1]);
+    TEST_ASSERT_EQUAL(0x04, frame[4]);
+    TEST_ASSERT_EQUAL(0x01, frame[7]);
+}
+
+void test_numeric_fields_little_endian() {
+    s.engine_rpm = 6500;
+    s.engine_temp = -40;
+    s.vehicle_speed = 255;
+    s.battery_voltage = 12.6f;
+    s.fuel_level = 33.5f;
+    encodeTelemetry(s, frame);
+    TEST_ASSERT_EQUAL(6500, u16(8));
+    TEST_ASSERT_EQUAL(-40, (int16_t)u16(10));
+    TEST_ASSERT_EQUAL(255, u16(12));
+    TEST_ASSERT_EQUAL(350, u16(14));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, f32(20));
+    TEST_ASSERT_EQUAL_FLOAT(33.5f, f32(32));
+    TEST_ASSERT_EQUAL_FLOAT(12.6f, f32(36));
+}
+
+void test_strings_are_nul_padded() {
+    strcpy(s.vin, "1HGCM82633A004352");
+    strcpy(s.cal_id, "CAL");
+    encodeTelemetry(s, frame);
+    TEST_ASSERT_EQUAL_MEMORY("1HGCM82633A004352", &frame[40], 17);
+    TEST_ASSERT_EQUAL_MEMORY("CAL\0\0", &frame[57], 5);
+    TEST_ASSERT_EQUAL(0, frame[72]);
+    TEST_ASSERT_EQUAL_MEMORY("A1B2C3D4", &frame[73], 8);
+}
+
+void test_dtcs_use_j1979_encoding() {
+    addDTC(s, "P0300");
+    addDTC(s, "U1A2F");
+    encodeTelemetry(s, frame);
+    TEST_ASSERT_EQUAL(2, frame[2]);
+    TEST_ASSERT_EQUAL(2, frame[3]);
+    TEST_ASSERT_EQUAL_HEX16(0x0300, u16(82));
+    TEST_ASSERT_EQUAL_HEX16(0xDA2F, u16(84));
+    TEST_ASSERT_EQUAL_HEX16(0x0000, u16(86)); // Порожні слоти - нулі
+    TEST_ASSERT_EQUAL_HEX16(0xDA2F, u16(94));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_and_flags);
+    RUN_TEST(test_numeric_fields_little_endian);
+    RUN_TEST(test_strings_are_nul_padded);
+    RUN_TEST(test_dtcs_use_j1979_encoding);
+    return UNITY_END();
+}
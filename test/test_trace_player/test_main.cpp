@@ -0,0 +1,178 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "trace_player.h"
+
+// Траса з рядка замість файлу
+class StringReader : public TraceReader {
+public:
+    explicit StringReader(const char *text) : text_(text), pos_(text) {}
+
+    bool readLine(char *buf, size_t size) override {
+        if (*pos_ == '\0') return false;
+        size_t len = strcspn(pos_, "\n");
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(buf, pos_, n);
+        buf[n] = '\0';
+        pos_ += len;
+        if (*pos_ == '\n') pos_++;
+        return true;
+    }
+
+    bool rewind() override {
+        pos_ = text_;
+        rewinds++;
+        return true;
+    }
+
+    int rewinds = 0;
+
+private:
+    const char *text_;
+    const char *pos_;
+};
+
+static const uint64_t MS = 1000;
+
+static VehicleState s;
+static TracePlayer player;
+
+void setUp() {
+    s = VehicleState();
+    player = TracePlayer();
+}
+
+void tearDown() {}
+
+void test_interpolates_between_rows() {
+    StringReader reader("t_ms,rpm,speed,maf\n0,1000,0,2.0\n1000,3000,100,12.0\n");
+    TEST_ASSERT_TRUE(player.begin(reader, 5000 * MS, 1.0f, false));
+    TEST_ASSERT_TRUE(player.advance(5250 * MS));
+    player.apply(s);
+    TEST_ASSERT_EQUAL(1500, s.engine_rpm);
+    TEST_ASSERT_EQUAL(25, s.vehicle_speed);
+    TEST_ASSERT_EQUAL(gearForSpeed(25), s.transmission_gear);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 4.5, s.maf_rate);
+}
+
+void test_empty_cell_holds_value() {
+    StringReader reader("t_ms,rpm,temp\n0,800,80\n1000,,90\n2000,2800,\n");
+    TEST_ASSERT_TRUE(player.begin(reader, 0, 1.0f, false));
+    player.advance(500 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL(800, s.engine_rpm); // Рядок 1000 успадкував 800
+    TEST_ASSERT_EQUAL(85, s.engine_temp);
+    player.advance(1750 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL(2300, s.engine_rpm);
+    TEST_ASSERT_EQUAL(90, s.engine_temp); // Рядок 2000 успадкував 90
+}
+
+void test_untouched_fields_keep_state() {
+    s.battery_voltage = 12.6f;
+    StringReader reader("t_ms,rpm\n0,800\n1000,900\n");
+    player.begin(reader, 0, 1.0f, false);
+    player.advance(500 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL_FLOAT(12.6f, s.battery_voltage);
+}
+
+void test_dtc_events_fire_once() {
+    StringReader reader("t_ms,rpm,dtc\n0,800,\n100,900,P0300\n200,900,P0171\n300,900,clear\n400,900,\n");
+    player.begin(reader, 0, 1.0f, false);
+    player.advance(250 * MS);
+    TEST_ASSERT_EQUAL(2, player.apply(s));
+    TEST_ASSERT_EQUAL(2, s.num_dtcs);
+    player.advance(260 * MS);
+    TEST_ASSERT_EQUAL(0, player.apply(s));
+    player.advance(350 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL(0, s.num_dtcs);
+    TEST_ASSERT_EQUAL(2, s.num_permanent_dtcs);
+}
+
+void test_dtc_counted_only_when_current_list_grows() {
+    for (const char *code : {"P0100", "P0101", "P0102", "P0103", "P0104"}) addDTC(s, code);
+    s.num_permanent_dtcs = 0; // Місце є лише в постійних
+    StringReader reader("t_ms,rpm,dtc\n0,800,P0300\n100,800,\n");
+    player.begin(reader, 0, 1.0f, false);
+    player.advance(50 * MS);
+    TEST_ASSERT_EQUAL(0, player.apply(s));
+    TEST_ASSERT_EQUAL(MAX_DTCS, s.num_dtcs);
+    TEST_ASSERT_EQUAL(1, s.num_permanent_dtcs);
+}
+
+void test_finishes_without_loop() {
+    StringReader reader("t_ms,rpm\n0,800\n1000,1800\n");
+    player.begin(reader, 0, 1.0f, false);
+    TEST_ASSERT_TRUE(player.advance(900 * MS));
+    TEST_ASSERT_FALSE(player.advance(1000 * MS));
+    player.apply(s);
+    TEST_ASSERT_EQUAL(1800, s.engine_rpm);
+}
+
+void test_loop_restarts_from_first_row() {
+    StringReader reader("t_ms,rpm\n100,1000\n1100,2000\n");
+    player.begin(reader, 0, 1.0f, true);
+    // Після останнього рядка (t=1000 від старту) траса починається знову з t_ms=100
+    TEST_ASSERT_TRUE(player.advance(1250 * MS));
+    player.apply(s);
+    TEST_ASSERT_EQUAL(1250, s.engine_rpm);
+    TEST_ASSERT_EQUAL(1, player.loops());
+    TEST_ASSERT_EQUAL(350, player.positionMs());
+    TEST_ASSERT_TRUE(player.advance(10250 * MS));
+    TEST_ASSERT_EQUAL(10, player.loops());
+}
+
+void test_single_row_loop_terminates() {
+    StringReader reader("t_ms,rpm\n0,800\n");
+    player.begin(reader, 0, 1.0f, true);
+    TEST_ASSERT_FALSE(player.advance(100 * MS));
+    player.apply(s);
+    TEST_ASSERT_EQUAL(800, s.engine_rpm);
+}
+
+void test_speed_scales_time() {
+    StringReader reader("t_ms,rpm\n0,0\n4000,4000\n");
+    player.begin(reader, 0, 4.0f, false);
+    player.advance(500 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL(2000, s.engine_rpm);
+}
+
+void test_comments_and_bad_rows_are_skipped() {
+    StringReader reader("# поїздка\n\n t_ms , rpm , unknown\r\n0,800,1\n# пауза\nxx,900,1\n500,1300,1\n400,100,1\n1000,1800,1\n");
+    TEST_ASSERT_TRUE(player.begin(reader, 0, 1.0f, false));
+    player.advance(750 * MS);
+    player.apply(s);
+    TEST_ASSERT_EQUAL(1550, s.engine_rpm);
+    TEST_ASSERT_EQUAL(2, player.skippedLines());
+}
+
+void test_bad_header_is_rejected() {
+    StringReader reader("rpm,t_ms\n800,0\n");
+    TEST_ASSERT_FALSE(player.begin(reader, 0));
+    TEST_ASSERT_FALSE(player.active());
+    TEST_ASSERT_EQUAL_STRING("first column must be t_ms", player.error());
+
+    StringReader empty("t_ms,rpm\n# нічого\n");
+    TEST_ASSERT_FALSE(player.begin(empty, 0));
+    TEST_ASSERT_EQUAL_STRING("trace has no data rows", player.error());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_interpolates_between_rows);
+    RUN_TEST(test_empty_cell_holds_value);
+    RUN_TEST(test_untouched_fields_keep_state);
+    RUN_TEST(test_dtc_events_fire_once);
+    RUN_TEST(test_dtc_counted_only_when_current_list_grows);
+    RUN_TEST(test_finishes_without_loop);
+    RUN_TEST(test_loop_restarts_from_first_row);
+    RUN_TEST(test_single_row_loop_terminates);
+    RUN_TEST(test_speed_scales_time);
+    RUN_TEST(test_comments_and_bad_rows_are_skipped);
+    RUN_TEST(test_bad_header_is_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,81 @@
+#include <unity.h>
+
+#include "tx_queue.h"
+
+static TxQueue queue;
+
+void setUp() {
+    queue = TxQueue();
+}
+
+void tearDown() {}
+
+static CanFrame frameWithId(uint32_t id) {
+    CanFrame frame = {};
+    frame.id = id;
+    frame.dlc = 8;
+    return frame;
+}
+
+void test_same_priority_keeps_fifo_order() {
+    TEST_ASSERT_TRUE(queue.push(frameWithId(1), 0, 1000));
+    TEST_ASSERT_TRUE(queue.push(frameWithId(2), 0, 1000));
+    CanFrame frame;
+    TEST_ASSERT_TRUE(queue.front(0, frame));
+    TEST_ASSERT_EQUAL_HEX32(1, frame.id);
+    queue.popFront();
+    TEST_ASSERT_TRUE(queue.front(0, frame));
+    TEST_ASSERT_EQUAL_HEX32(2, frame.id);
+    queue.popFront();
+    TEST_ASSERT_FALSE(queue.front(0, frame));
+}
+
+void test_higher_priority_goes_first() {
+    queue.push(frameWithId(1), 1, 1000);
+    queue.push(frameWithId(2), 0, 1000);
+    CanFrame frame;
+    queue.front(0, frame);
+    TEST_ASSERT_EQUAL_HEX32(2, frame.id);
+}
+
+void test_expired_frames_are_dropped() {
+    queue.push(frameWithId(1), 0, 100);
+    queue.push(frameWithId(2), 0, 300);
+    CanFrame frame;
+    TEST_ASSERT_TRUE(queue.front(200, frame));
+    TEST_ASSERT_EQUAL_HEX32(2, frame.id);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats().expired);
+}
+
+void test_deadline_survives_timer_wraparound() {
+    queue.push(frameWithId(1), 0, 50); // Дедлайн після переповнення micros()
+    CanFrame frame;
+    TEST_ASSERT_TRUE(queue.front(0xFFFFFF00UL, frame));
+    TEST_ASSERT_EQUAL_UINT32(0, queue.stats().expired);
+}
+
+void test_full_queue_evicts_lower_priority() {
+    for (size_t i = 0; i < TxQueue::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queue.push(frameWithId(i), 1, 1000));
+    }
+    TEST_ASSERT_FALSE(queue.push(frameWithId(100), 1, 1000));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats().dropped_full);
+
+    TEST_ASSERT_TRUE(queue.push(frameWithId(200), 0, 1000));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.stats().evicted);
+    TEST_ASSERT_EQUAL(TxQueue::CAPACITY, queue.size());
+
+    CanFrame frame;
+    queue.front(0, frame);
+    TEST_ASSERT_EQUAL_HEX32(200, frame.id);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_same_priority_keeps_fifo_order);
+    RUN_TEST(test_higher_priority_goes_first);
+    RUN_TEST(test_expired_frames_are_dropped);
+    RUN_TEST(test_deadline_survives_timer_wraparound);
+    RUN_TEST(test_full_queue_evicts_lower_priority);
+    return UNITY_END();
+}
@@ -0,0 +1,121 @@
+#include <unity.h>
+
+#include "vehicle_sim.h"
+
+static VehicleState s;
+static VehicleSim sim;
+
+static const int STEPS_PER_SECOND = 1000 / VehicleSim::STEP_MS;
+
+static void run(int seconds) {
+    for (int i = 0; i < seconds * STEPS_PER_SECOND; i++) sim.step(s);
+}
+
+void setUp() {
+    s = VehicleState();
+    s.engine_rpm = 800;
+    s.vehicle_speed = 0;
+    s.transmission_gear = 0;
+    s.engine_temp = 20;
+    s.dynamic_rpm_enabled = true;
+    sim = VehicleSim();
+    sim.reset(s);
+}
+
+void tearDown() {}
+
+void test_idles_at_standstill() {
+    run(3);
+    TEST_ASSERT_EQUAL(0, s.vehicle_speed);
+    TEST_ASSERT_EQUAL(0, s.transmission_gear);
+    TEST_ASSERT_EQUAL(800, s.engine_rpm);
+    TEST_ASSERT_TRUE(s.maf_rate > 1.0f && s.maf_rate < 5.0f);
+}
+
+void test_throttle_accelerates_and_upshifts() {
+    run(12); // Кінець розгону в циклі їзди
+    TEST_ASSERT_TRUE(sim.throttle() > 0.5f);
+    TEST_ASSERT_TRUE(s.vehicle_speed > 30);
+    TEST_ASSERT_TRUE(s.transmission_gear >= 2);
+    TEST_ASSERT_TRUE(s.engine_rpm > 1500);
+    TEST_ASSERT_TRUE(s.maf_rate > 15.0f);
+    TEST_ASSERT_TRUE(s.fuel_rate > 5.0f);
+}
+
+void test_cycle_ends_at_standstill() {
+    run(49);
+    TEST_ASSERT_EQUAL(0, s.vehicle_speed);
+    TEST_ASSERT_EQUAL(0, s.transmission_gear);
+}
+
+void test_coolant_warms_up_and_thermostat_holds() {
+    run(60);
+    TEST_ASSERT_TRUE(s.engine_temp > 40);
+    run(20 * 60);
+    TEST_ASSERT_TRUE(s.engine_temp >= 85);
+    TEST_ASSERT_TRUE(s.engine_temp <= 95);
+}
+
+void test_fuel_level_goes_down() {
+    const float start = s.fuel_level;
+    run(5 * 60);
+    TEST_ASSERT_TRUE(s.fuel_level < start);
+    TEST_ASSERT_TRUE(s.fuel_level > start - 2);
+}
+
+void test_distance_with_mil_counts_whole_km() {
+    addDTC(s, "P0171");
+    run(10 * 60);
+    // ~0.5 км за цикл їзди в 50 с
+    TEST_ASSERT_TRUE(s.distance_with_mil >= 3);
+    TEST_ASSERT_TRUE(s.distance_with_mil <= 10);
+}
+
+void test_external_change_is_picked_up() {
+    run(1);
+    s.engine_temp = 95; // /update посеред симуляції
+    sim.step(s);
+    TEST_ASSERT_EQUAL(95, s.engine_temp);
+    s.fuel_level = 10;
+    sim.step(s);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10, s.fuel_level);
+}
+
+void test_misfire_simulation_sets_dtc_once() {
+    s.misfire_simulation_enabled = true;
+    int added = 0;
+    for (int i = 0; i < 50 * STEPS_PER_SECOND; i++) {
+        const char *dtc = sim.step(s);
+        if (dtc) {
+            TEST_ASSERT_EQUAL_STRING("P0300", dtc);
+            TEST_ASSERT_TRUE(s.engine_rpm > 3500);
+            added++;
+        }
+    }
+    TEST_ASSERT_EQUAL(1, added);
+    TEST_ASSERT_EQUAL(1, s.num_dtcs);
+}
+
+void test_same_start_gives_same_run() {
+    run(30);
+    const VehicleState first = s;
+    setUp();
+    run(30);
+    TEST_ASSERT_EQUAL(first.engine_rpm, s.engine_rpm);
+    TEST_ASSERT_EQUAL(first.vehicle_speed, s.vehicle_speed);
+    TEST_ASSERT_EQUAL_FLOAT(first.fuel_level, s.fuel_level);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_idles_at_standstill);
+    RUN_TEST(test_throttle_accelerates_and_upshifts);
+    RUN_TEST(test_cycle_ends_at_standstill);
+    RUN_TEST(test_coolant_warms_up_and_thermostat_holds);
+    RUN_TEST(test_fuel_level_goes_down);
+    RUN_TEST(test_distance_with_mil_counts_whole_km);
+    RUN_TEST(test_external_change_is_picked_up);
+    RUN_TEST(test_misfire_simulation_sets_dtc_once);
+    RUN_TEST(test_same_start_gives_same_run);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+
+#include <map>
+#include <string>
+
+#include "vehicle_state.h"
+
+class MapParams : public StateParams {
+public:
+    std::map<std::string, std::string> values;
+    const char *get(const char *name) const override {
+        auto it = values.find(name);
+        return it == values.end() ? nullptr : it->second.c_str();
+    }
+};
+
+static VehicleState s;
+static MapParams params;
+
+void setUp() {
+    s = VehicleState();
+    params.values.clear();
+}
+
+void tearDown() {}
+
+void test_dtc_list_fills_both_lists() {
+    params.values["dtc_list"] = "P0300, P0171,bad,P0420";
+    applyStateUpdate(s, params);
+    TEST_ASSERT_EQUAL(3, s.num_dtcs);
+    TEST_ASSERT_EQUAL(3, s.num_permanent_dtcs);
+    TEST_ASSERT_EQUAL_STRING("P0171", s.dtcs[1]);
+    TEST_ASSERT_EQUAL_STRING("P0420", s.permanent_dtcs[2]);
+}
+
+void test_legacy_dtc_fields() {
+    params.values["dtc1_sys"] = "P";
+    params.values["dtc1_type"] = "0";
+    params.values["dtc1_code"] = "300";
+    params.values["dtc2_code"] = "";
+    applyStateUpdate(s, params);
+    TEST_ASSERT_EQUAL(1, s.num_dtcs);
+    TEST_ASSERT_EQUAL_STRING("P0300", s.dtcs[0]);
+}
+
+void test_update_replaces_dtcs_and_sets_values() {
+    addDTC(s, "P0300");
+    params.values["speed"] = "130";
+    params.values["maf"] = "12.5";
+    params.values["dynamic_rpm"] = "on";
+    params.values["vin"] = "1HGCM82633A004352";
+    applyStateUpdate(s, params);
+    TEST_ASSERT_EQUAL(0, s.num_dtcs);
+    TEST_ASSERT_EQUAL(130, s.vehicle_speed);
+    TEST_ASSERT_EQUAL(6, s.transmission_gear);
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, s.maf_rate);
+    TEST_ASSERT_TRUE(s.dynamic_rpm_enabled);
+    TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", s.vin);
+    TEST_ASSERT_EQUAL(1500, s.engine_rpm); // Без параметра - без змін
+}
+
+void test_clear_keeps_permanent_dtcs() {
+    addDTC(s, "P0300");
+    s.distance_with_mil = 42;
+    clearCurrentDtcs(s);
+    TEST_ASSERT_EQUAL(0, s.num_dtcs);
+    TEST_ASSERT_EQUAL(0, s.distance_with_mil);
+    TEST_ASSERT_EQUAL(1, s.num_permanent_dtcs);
+}
+
+void test_driving_cycles_clear_permanent_dtcs() {
+    addDTC(s, "P0300");
+    TEST_ASSERT_FALSE(applyDrivingCycle(s)); // Поточний DTC - цикл не рахується
+    TEST_ASSERT_EQUAL(0, s.error_free_cycles);
+
+    clearCurrentDtcs(s);
+    for (int i = 1; i < CYCLES_THRESHOLD; i++) TEST_ASSERT_FALSE(applyDrivingCycle(s));
+    TEST_ASSERT_TRUE(applyDrivingCycle(s));
+    TEST_ASSERT_EQUAL(0, s.num_permanent_dtcs);
+}
+
+void test_update_keeps_freeze_frames_in_step_with_dtcs() {
+    s.engine_rpm = 4200;
+    addDTC(s, "P0300");
+
+    params.values["dtc_list"] = "P0171,P0300";
+    params.values["rpm"] = "1800";
+    applyStateUpdate(s, params);
+    TEST_ASSERT_EQUAL(2, s.num_freeze_frames);
+    // Новий код - кадр з нових значень, старий - зберігає свій
+    TEST_ASSERT_EQUAL_STRING("P0171", s.freeze_frames[0].dtc);
+    TEST_ASSERT_EQUAL(1800, s.freeze_frames[0].engine_rpm);
+    TEST_ASSERT_EQUAL_STRING("P0300", s.freeze_frames[1].dtc);
+    TEST_ASSERT_EQUAL(4200, s.freeze_frames[1].engine_rpm);
+
+    params.values["dtc_list"] = "";
+    applyStateUpdate(s, params);
+    TEST_ASSERT_EQUAL(0, s.num_freeze_frames);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_dtc_list_fills_both_lists);
+    RUN_TEST(test_legacy_dtc_fields);
+    RUN_TEST(test_update_replaces_dtcs_and_sets_values);
+    RUN_TEST(test_clear_keeps_permanent_dtcs);
+    RUN_TEST(test_driving_cycles_clear_permanent_dtcs);
+    RUN_TEST(test_update_keeps_freeze_frames_in_step_with_dtcs);
+    return UNITY_END();
+}
@@ -0,0 +1,376 @@
+function showPage(pageId, element) {
+    document.querySelectorAll('.page-content').forEach(page => page.style.display = 'none');
+    document.querySelectorAll('.tab-button').forEach(btn => btn.classList.remove('active'));
+
+    const pageToShow = document.getElementById(pageId);
+    pageToShow.style.display = 'block';
+    if (element) {
+        element.classList.add('active');
+    }
+
+    if (pageId === 'page-live') {
+        resizeCanvas(); // Redraw chart when its tab is shown
+    }
+}
+
+// Поля, які користувач змінив, але ще не надіслав: живі оновлення їх не перезаписують
+const editedFields = new Set();
+document.getElementById('updateForm').addEventListener('input', event => editedFields.add(event.target.id));
+
+document.getElementById('updateForm').addEventListener('submit', function(event) {
+    event.preventDefault(); // Запобігаємо перезавантаженню сторінки
+
+    const form = event.target;
+    const formData = new FormData(form);
+    const params = new URLSearchParams();
+    // Додаємо в запит тільки ті параметри, які мають значення
+    for (const pair of formData) {
+        if (pair[1]) {
+            params.append(pair[0], pair[1]);
+        }
+    }
+
+    const url = form.action + '?' + params.toString();
+
+    const submitBtn = document.getElementById('submitBtn');
+    const statusDiv = document.getElementById('status');
+
+    submitBtn.value = 'Updating...';
+    submitBtn.disabled = true;
+    statusDiv.textContent = '';
+
+    fetch(url)
+        .then(response => response.text())
+        .then(data => {
+            statusDiv.textContent = data;
+            statusDiv.style.color = 'green';
+            editedFields.clear(); // Далі поля знову показують стан емулятора
+        })
+        .catch(error => {
+            statusDiv.textContent = 'Error: Could not connect to the server.';
+            statusDiv.style.color = 'red';
+        })
+        .finally(() => {
+            submitBtn.value = 'Update Emulator Data';
+            submitBtn.disabled = false;
+            setTimeout(() => { statusDiv.textContent = ''; }, 5000); // Очистити статус через 5 секунд
+        });
+});
+
+function toggleDynamicRPM(cb) {
+    fetch('/update?dynamic_rpm=' + (cb.checked ? 'true' : 'false'));
+}
+
+function toggleMisfireSim(cb) {
+    fetch('/update?misfire_sim=' + (cb.checked ? 'true' : 'false'));
+}
+
+function toggleLeanMixtureSim(cb) {
+    fetch('/update?lean_mixture_sim=' + (cb.checked ? 'true' : 'false'));
+}
+
+document.getElementById('clearDtcBtn').addEventListener('click', function() {
+    const btn = this;
+    const statusDiv = document.getElementById('status');
+
+    btn.textContent = 'Clearing...';
+    btn.disabled = true;
+    statusDiv.textContent = '';
+
+    fetch('/clear_dtc')
+        .then(response => response.text())
+        .then(data => {
+            statusDiv.textContent = data;
+            statusDiv.style.color = 'blue';
+            document.getElementById('dtc_list').value = ''; // Очищаємо поле вводу DTC
+        })
+        .catch(error => {
+            statusDiv.textContent = 'Error: Could not connect to the server.';
+            statusDiv.style.color = 'red';
+        })
+        .finally(() => {
+            btn.textContent = 'Clear All DTCs';
+            btn.disabled = false;
+            setTimeout(() => { statusDiv.textContent = ''; }, 5000);
+        });
+});
+
+document.getElementById('cycleBtn').addEventListener('click', function() {
+    const btn = this;
+    const statusDiv = document.getElementById('status');
+
+    btn.disabled = true;
+    statusDiv.textContent = 'Simulating cycle...';
+
+    fetch('/cycle')
+        .then(response => response.text())
+        .then(data => {
+            statusDiv.textContent = data;
+            statusDiv.style.color = 'blue';
+        })
+        .catch(error => {
+            statusDiv.textContent = 'Error: Could not connect to the server.';
+            statusDiv.style.color = 'red';
+        })
+        .finally(() => {
+            btn.disabled = false;
+            setTimeout(() => { statusDiv.textContent = ''; }, 3000);
+        });
+});
+
+let gateway = `ws://${window.location.host}/ws`;
+let websocket;
+
+// --- Chart Logic ---
+const canvas = document.getElementById('rpmChart');
+const ctx = canvas.getContext('2d');
+// Точки додаються з фіксованим кроком, незалежно від частоти оновлень (JSON 2 Гц, "bin" 20 Гц):
+// 60 точок по 500 мс - 30 секунд історії
+const CHART_SAMPLE_MS = 500;
+let speedHistory = new Array(60).fill(0); // Історія на 60 точок
+let rpmHistory = new Array(60).fill(0); // Історія на 60 точок
+let tempHistory = new Array(60).fill(0); // Історія на 60 точок
+let mafHistory = new Array(60).fill(0);
+let timingHistory = new Array(60).fill(0);
+let fuelRateHistory = new Array(60).fill(0);
+
+// Load chart settings
+const chartSettings = ['chart_max_rpm', 'chart_max_speed', 'chart_max_temp', 'chart_max_maf', 'chart_max_timing', 'chart_max_fuel'];
+chartSettings.forEach(id => {
+    if(localStorage.getItem(id)) document.getElementById(id).value = localStorage.getItem(id);
+    document.getElementById(id).addEventListener('change', updateChartSettings);
+});
+
+function updateChartSettings() {
+    chartSettings.forEach(id => {
+        localStorage.setItem(id, document.getElementById(id).value);
+    });
+    drawChart();
+}
+
+function resizeCanvas() {
+    canvas.width = canvas.clientWidth;
+    canvas.height = canvas.clientHeight;
+    drawChart();
+}
+window.addEventListener('resize', resizeCanvas);
+
+function drawChart() {
+    const w = canvas.width;
+    const h = canvas.height;
+    ctx.clearRect(0, 0, w, h);
+    ctx.font = '12px Arial';
+
+    const maxRPM = parseFloat(document.getElementById('chart_max_rpm').value) || 6000;
+    const maxSpeed = parseFloat(document.getElementById('chart_max_speed').value) || 200;
+    const maxTemp = parseFloat(document.getElementById('chart_max_temp').value) || 150;
+    const maxMaf = parseFloat(document.getElementById('chart_max_maf').value) || 100;
+    const maxTiming = parseFloat(document.getElementById('chart_max_timing').value) || 60;
+    const maxFuel = parseFloat(document.getElementById('chart_max_fuel').value) || 20;
+
+    const step = w / (rpmHistory.length - 1);
+
+    function drawLine(history, maxVal, color) {
+        ctx.beginPath();
+        ctx.strokeStyle = color;
+        ctx.lineWidth = 2;
+        for (let i = 0; i < history.length; i++) {
+            let val = history[i];
+            let y = h - (val / maxVal * h);
+            if (y < 0) y = 0; // Clip top
+            if (y > h) y = h; // Clip bottom
+            if (i === 0) ctx.moveTo(0, y);
+            else ctx.lineTo(i * step, y);
+        }
+        ctx.stroke();
+    }
+
+    drawLine(rpmHistory, maxRPM, '#2196F3'); // Blue
+    drawLine(speedHistory, maxSpeed, '#4CAF50'); // Green
+    drawLine(tempHistory, maxTemp, '#f44336'); // Red
+    drawLine(mafHistory, maxMaf, '#FF9800'); // Orange
+    drawLine(timingHistory, maxTiming, '#9C27B0'); // Purple
+    drawLine(fuelRateHistory, maxFuel, '#00BCD4'); // Cyan
+
+    // --- Draw Legend ---
+    let lx = 10;
+    ctx.fillStyle = '#2196F3';
+    ctx.fillText('RPM', lx, 15); lx += 40;
+    ctx.fillStyle = '#4CAF50';
+    ctx.fillText('Speed', lx, 15); lx += 50;
+    ctx.fillStyle = '#f44336';
+    ctx.fillText('Temp', lx, 15); lx += 40;
+    ctx.fillStyle = '#FF9800';
+    ctx.fillText('MAF', lx, 15); lx += 40;
+    ctx.fillStyle = '#9C27B0';
+    ctx.fillText('Timing', lx, 15); lx += 50;
+    ctx.fillStyle = '#00BCD4';
+    ctx.fillText('Fuel', lx, 15);
+}
+
+function initWebSocket() {
+    console.log('Trying to open a WebSocket connection...');
+    websocket = new WebSocket(gateway);
+    websocket.binaryType = 'arraybuffer';
+    websocket.onopen    = onOpen;
+    websocket.onclose   = onClose;
+    websocket.onmessage = onMessage;
+}
+
+function onOpen(event) {
+    console.log('Connection opened');
+    websocket.send('bin'); // Бінарна телеметрія замість JSON (частіші оновлення)
+}
+
+function onClose(event) {
+    console.log('Connection closed');
+    setTimeout(initWebSocket, 2000); // Спробувати перепідключитися через 2 секунди
+}
+
+// Бінарна телеметрія: розкладка описана в lib/obd_core/src/telemetry.h
+const TELEMETRY_SCHEMA = 1;
+const TELEMETRY_FRAME_SIZE = 102;
+
+function decodeTelemetry(buffer) {
+    const v = new DataView(buffer);
+    if (buffer.byteLength < TELEMETRY_FRAME_SIZE || v.getUint8(0) !== TELEMETRY_SCHEMA) {
+        console.warn('Unknown telemetry schema, falling back to JSON');
+        websocket.send('json');
+        return null;
+    }
+    const str = (offset, size) => {
+        let s = '';
+        for (let i = 0; i < size && v.getUint8(offset + i) !== 0; i++) s += String.fromCharCode(v.getUint8(offset + i));
+        return s;
+    };
+    const dtcs = (offset, count) => {
+        const list = [];
+        for (let i = 0; i < count && i < 5; i++) {
+            const code = v.getUint16(offset + i * 2, true);
+            const a = code >> 8, b = code & 0xFF;
+            list.push('PCBU'[a >> 6] + ((a >> 4) & 3) + (a & 0x0F).toString(16) +
+                      (b >> 4).toString(16) + (b & 0x0F).toString(16));
+        }
+        return list.map(c => c.toUpperCase());
+    };
+    const fixed = (value, digits) => Number(value.toFixed(digits));
+    const flags = v.getUint8(1);
+    return {
+        rpm: v.getUint16(8, true),
+        temp: v.getInt16(10, true),
+        speed: v.getUint16(12, true),
+        fuel_pressure: v.getUint16(14, true),
+        dist_mil: v.getUint16(16, true),
+        cycles: v.getUint16(18, true),
+        maf: fixed(v.getFloat32(20, true), 2),
+        timing: fixed(v.getFloat32(24, true), 1),
+        fuel_rate: fixed(v.getFloat32(28, true), 2),
+        fuel: fixed(v.getFloat32(32, true), 1),
+        voltage: fixed(v.getFloat32(36, true), 1),
+        vin: str(40, 17),
+        cal_id: str(57, 16),
+        cvn: str(73, 8),
+        dtcs: dtcs(82, v.getUint8(2)),
+        permanent_dtcs: dtcs(92, v.getUint8(3)),
+        dynamic_rpm: (flags & 1) !== 0,
+        misfire_sim: (flags & 2) !== 0,
+        lean_mixture_sim: (flags & 4) !== 0,
+    };
+}
+
+// Накопичений стан: JSON-повідомлення після ключового кадру містять лише змінені поля
+const liveState = {};
+
+function onMessage(event) {
+    const update = event.data instanceof ArrayBuffer ? decodeTelemetry(event.data) : JSON.parse(event.data);
+    if (!update) return;
+    Object.assign(liveState, update);
+    if (!liveState.dtcs) return; // Ще не було ключового кадру
+    const data = liveState;
+
+    // Оновлюємо блок "Live Status"
+    document.getElementById('status_vin').textContent = data.vin;
+    document.getElementById('status_cal_id').textContent = data.cal_id;
+    document.getElementById('status_cvn').textContent = data.cvn;
+    document.getElementById('status_rpm').textContent = data.rpm;
+    document.getElementById('status_temp').textContent = data.temp;
+    document.getElementById('status_speed').textContent = data.speed;
+    document.getElementById('status_maf').textContent = data.maf;
+    document.getElementById('status_timing').textContent = data.timing;
+    document.getElementById('status_fuel_rate').textContent = data.fuel_rate;
+    document.getElementById('status_fuel').textContent = data.fuel;
+    document.getElementById('status_dist_mil').textContent = data.dist_mil;
+    document.getElementById('status_cycles').textContent = data.cycles;
+    document.getElementById('status_voltage').textContent = data.voltage;
+    document.getElementById('status_dtcs').textContent = data.dtcs.length > 0 ? data.dtcs.join(', ') : 'None';
+    document.getElementById('status_permanent_dtcs').textContent = (data.permanent_dtcs && data.permanent_dtcs.length > 0) ? data.permanent_dtcs.join(', ') : 'None';
+
+    if (data.dynamic_rpm !== undefined) {
+        document.getElementById('dynamic_rpm_check').checked = data.dynamic_rpm;
+    }
+
+    if (data.misfire_sim !== undefined) {
+        document.getElementById('misfire_sim_check').checked = data.misfire_sim;
+    }
+
+    if (data.lean_mixture_sim !== undefined) {
+        document.getElementById('lean_mixture_sim_check').checked = data.lean_mixture_sim;
+    }
+
+    // Синхронізуємо поля форми
+    syncField('vin', data.vin);
+    syncField('cal_id', data.cal_id);
+    syncField('cvn', data.cvn);
+    syncField('rpm', data.rpm);
+    syncField('temp', data.temp);
+    syncField('speed', data.speed);
+    syncField('maf', data.maf);
+    syncField('timing', data.timing);
+    syncField('fuel_pressure', data.fuel_pressure);
+    syncField('fuel_rate', data.fuel_rate);
+    syncField('fuel', data.fuel);
+    syncField('dist_mil', data.dist_mil);
+    syncField('voltage', data.voltage);
+    syncField('dtc_list', data.dtcs.join(','));
+}
+
+// Поле оновлюється лише коли значення змінилося, а користувач його не редагує
+function syncField(id, value) {
+    const text = String(value);
+    const input = document.getElementById(id);
+    if (input.value === text || editedFields.has(id) || document.activeElement === input) return;
+    input.value = text;
+}
+
+// Оновлення графіку - з кроком CHART_SAMPLE_MS
+function sampleChart() {
+    if (!liveState.dtcs) return; // Ще не було ключового кадру
+    const data = liveState;
+    speedHistory.push(data.speed);
+    if (speedHistory.length > 60) speedHistory.shift();
+
+    rpmHistory.push(data.rpm);
+    if (rpmHistory.length > 60) rpmHistory.shift();
+
+    tempHistory.push(data.temp);
+    if (tempHistory.length > 60) tempHistory.shift();
+
+    mafHistory.push(data.maf);
+    if (mafHistory.length > 60) mafHistory.shift();
+
+    timingHistory.push(data.timing);
+    if (timingHistory.length > 60) timingHistory.shift();
+
+    fuelRateHistory.push(data.fuel_rate);
+    if (fuelRateHistory.length > 60) fuelRateHistory.shift();
+
+    drawChart();
+}
+
+window.addEventListener('load', function() {
+    // Show the first tab by default
+    showPage('page-general', document.querySelector('.tab-button'));
+    resizeCanvas();
+    initWebSocket();
+    setInterval(sampleChart, CHART_SAMPLE_MS);
+});